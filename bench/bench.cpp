@@ -0,0 +1,692 @@
+/* 
+熱點微基準測試：量測每個操作的時間 (ns/op) 與記憶體配置次數 (allocs/op)，
+可以輸出成基準檔，之後與提交在版本庫中的基準比較，抓出效能退步
+
+Compile command:
+g++ -std=c++11 -O2 ./bench/bench.cpp\
+    ./src/Board.cpp ./src/BoardBatch.cpp ./src/Tetromino.cpp ./src/InputHandler.cpp ./src/Renderer.cpp ./src/ScoreManager.cpp ./src/FrameTimer.cpp\
+    -o bench_oblivionis
+
+Usage:
+./bench_oblivionis [--filter TEXT] [--out FILE] [--compare FILE] [--tolerance 0.25] [--strict-time]
+
+輸出格式 (基準檔也是同樣格式)，每行一個測試，以 tab 分隔：
+name    ns_per_op    allocs_per_op    relative
+relative 是 ns_per_op 除以同一個行程裡校準工作 (calibration/lcg-table，與專案程式碼無關的整數運算與 L1 查表) 的 ns/op，
+大致抵銷機器快慢的差異。ns_per_op 只在錄製基準的機器上有意義，比較時只看 relative。
+--compare 時每次操作多配置了記憶體的項目一定算退步 (結束碼為 1)；relative 比基準慢超過 tolerance (預設 25%)
+只標示 SLOWER，加上 --strict-time 才算退步 (適合在錄製基準的同一台機器上使用)
+*/
+
+#include "../src/Board.hpp"
+#include "../src/BoardBatch.hpp"
+#include "../src/Tetromino.hpp"
+#include "../src/InputHandler.hpp"
+#include "../src/Renderer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// 計算整個程式的記憶體配置次數
+static std::atomic<long long> allocationCount(0);
+
+// new/delete 不可內聯：否則 GCC 看到 malloc() 與 free() 直接配對 new/delete 會誤報 -Wmismatched-new-delete
+#define BENCH_NOINLINE __attribute__((noinline))
+
+BENCH_NOINLINE void* operator new(std::size_t size) 
+{
+    allocationCount++;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) 
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+BENCH_NOINLINE void* operator new[](std::size_t size) 
+{
+    allocationCount++;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) 
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+BENCH_NOINLINE void operator delete(void* p) noexcept 
+{
+    std::free(p);
+}
+
+BENCH_NOINLINE void operator delete[](void* p) noexcept 
+{
+    std::free(p);
+}
+
+BENCH_NOINLINE void operator delete(void* p, std::size_t) noexcept 
+{
+    std::free(p);
+}
+
+BENCH_NOINLINE void operator delete[](void* p, std::size_t) noexcept 
+{
+    std::free(p);
+}
+
+namespace 
+{
+    // 讓編譯器無法把被量測的結果最佳化掉
+    volatile long long benchSink;
+
+    const double MIN_SAMPLE_SECONDS = 0.05;
+    const int SAMPLES = 5;
+
+    struct Result 
+    {
+        std::string name;
+        double nsPerOp;
+        double allocsPerOp;
+        double relative;   // nsPerOp / 校準工作的 ns/op；0 表示沒有 (舊格式的基準檔)
+    };
+
+    std::vector<Result> results;
+    std::string filter;
+
+    // 校準工作的 ns/op，在所有測試之前量測
+    double calibrationNs = 0.0;
+
+    // fn() 每次呼叫執行 opsPerCall 個操作；先找出能跑滿 MIN_SAMPLE_SECONDS 的呼叫次數，
+    // 再取 SAMPLES 次量測中最快的一次 (最不受其他行程干擾)
+    template <typename F>
+    void measure(const std::string& name, long opsPerCall, F fn) 
+    {
+        if (!filter.empty() && name.find(filter) == std::string::npos) 
+        {
+            return;
+        }
+
+        fn();  // 暖身
+
+        long calls = 1;
+        for (;;) 
+        {
+            auto begin = std::chrono::steady_clock::now();
+            for (long i = 0; i < calls; ++i) 
+            {
+                fn();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            if (seconds >= MIN_SAMPLE_SECONDS) 
+            {
+                break;
+            }
+            calls *= 2;
+        }
+
+        double best = 1e300;
+        long long allocations = allocationCount;
+        for (int s = 0; s < SAMPLES; ++s) 
+        {
+            auto begin = std::chrono::steady_clock::now();
+            for (long i = 0; i < calls; ++i) 
+            {
+                fn();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            best = std::min(best, seconds);
+        }
+        allocations = allocationCount - allocations;
+
+        double ops = static_cast<double>(calls) * opsPerCall;
+        double nsPerOp = best * 1e9 / ops;
+        Result result = { name, nsPerOp, allocations / (ops * SAMPLES), calibrationNs > 0.0 ? nsPerOp / calibrationNs : 1.0 };
+        results.push_back(result);
+        std::printf("%s\t%.3f\t%.3f\t%.4f\n", result.name.c_str(), result.nsPerOp, result.allocsPerOp, result.relative);
+        std::fflush(stdout);
+    }
+
+    // 校準：固定的整數乘加與 1 KB 表格的讀寫 (相依鏈，不會被向量化)，
+    // 代表這台機器此刻的單執行緒速度。不受 --filter 影響，每次都量測
+    void calibrate() 
+    {
+        static uint32_t table[256];
+        for (int i = 0; i < 256; ++i) 
+        {
+            table[i] = static_cast<uint32_t>(i * 2654435761u);
+        }
+        uint64_t state = 88172645463325252ull;
+
+        std::string saved;
+        saved.swap(filter);
+        measure("calibration/lcg-table", 64, [&]() 
+        {
+            for (int i = 0; i < 64; ++i) 
+            {
+                state = state * 6364136223846793005ull + 1442695040888963407ull;
+                uint32_t& slot = table[state >> 56];
+                slot = (slot ^ static_cast<uint32_t>(state >> 32)) + (slot >> 3);
+            }
+            benchSink += state;
+        });
+        filter.swap(saved);
+        calibrationNs = results.back().nsPerOp;
+    }
+
+    Tetromino makeTetromino(int type, int rotation, int row, int col) 
+    {
+        Tetromino tetromino;
+        tetromino.reset(static_cast<TetrominoType>(type), type + 1, Board::SPAWN_COL);
+        for (int i = 0; i < rotation; ++i) 
+        {
+            tetromino.rotateRight();
+        }
+        for (int i = 0; i < row; ++i) 
+        {
+            tetromino.moveDown();
+        }
+        for (int c = 4; c < col; ++c) 
+        {
+            tetromino.moveRight();
+        }
+        for (int c = 4; c > col; --c) 
+        {
+            tetromino.moveLeft();
+        }
+        return tetromino;
+    }
+
+    // 隨機旋轉、隨機欄位直接落下，直到堆疊達到 targetHeight 行 (不消行，保留原本已填滿的行)
+    void stackRandomly(Board& board, int targetHeight, std::mt19937& rng) 
+    {
+        for (int attempts = 0; attempts < 10000; ++attempts) 
+        {
+            int height = 0;
+            for (int r = 0; r < Board::HEIGHT; ++r) 
+            {
+                if (board.getRowMask(r)) 
+                {
+                    height = Board::HEIGHT - r;
+                    break;
+                }
+            }
+            if (height >= targetHeight) 
+            {
+                return;
+            }
+
+            Tetromino tetromino = makeTetromino(rng() % 7, rng() % 4, 0, rng() % Board::WIDTH);
+            if (board.checkCollision(tetromino)) 
+            {
+                continue;
+            }
+            do 
+            {
+                tetromino.moveDown();
+            } while (!board.checkCollision(tetromino));
+            tetromino.moveUp();
+
+            board.placeTetromino(tetromino);
+        }
+    }
+
+    // 隨機堆疊到 targetHeight 行，再消掉已填滿的行 (一般對局中的盤面)
+    Board makeStackedBoard(int targetHeight, std::mt19937& rng) 
+    {
+        Board board;
+        stackRandomly(board, targetHeight, rng);
+        board.clearLines();
+        return board;
+    }
+
+    // 底部四行以 I 與 O 方塊填滿 (等著一次四消)，上面再隨機堆到 targetHeight 行
+    Board makeTetrisBoard(int targetHeight, std::mt19937& rng) 
+    {
+        Board board;
+        for (int r = Board::HEIGHT - 4; r < Board::HEIGHT; r += 2) 
+        {
+            board.placeTetromino(makeTetromino(1, 0, r, 8));
+            for (int row = r; row < r + 2; ++row) 
+            {
+                board.placeTetromino(makeTetromino(0, 0, row, 0));
+                board.placeTetromino(makeTetromino(0, 0, row, 4));
+            }
+        }
+        stackRandomly(board, targetHeight, rng);
+        return board;
+    }
+
+    // 一批在棋盤範圍內的方塊 (不一定與既有方塊重疊)，用來輪流檢查碰撞與放置
+    std::vector<Tetromino> makePieces(std::mt19937& rng, int count) 
+    {
+        std::vector<Tetromino> pieces;
+        Board empty;
+        while (static_cast<int>(pieces.size()) < count) 
+        {
+            Tetromino tetromino = makeTetromino(rng() % 7, rng() % 4, rng() % Board::HEIGHT, rng() % Board::WIDTH);
+            if (!empty.checkCollision(tetromino)) 
+            {
+                pieces.push_back(tetromino);
+            }
+        }
+        return pieces;
+    }
+
+    void benchBoard() 
+    {
+        std::mt19937 rng(12345);
+        std::vector<Tetromino> pieces = makePieces(rng, 256);
+
+        struct NamedBoard 
+        {
+            const char* name;
+            Board board;
+        };
+        NamedBoard boards[] = 
+        {
+            { "empty", Board() },
+            { "half", makeStackedBoard(10, rng) },
+            { "high", makeStackedBoard(17, rng) },
+        };
+
+        Board copySource = boards[1].board;
+        measure("board/copy", 1, [&]() 
+        {
+            Board copy = copySource;
+            benchSink += copy.getRowMask(Board::HEIGHT - 1);
+        });
+
+        for (const NamedBoard& b : boards) 
+        {
+            measure(std::string("board/checkCollision/") + b.name, pieces.size(), [&]() 
+            {
+                int hits = 0;
+                for (const Tetromino& tetromino : pieces) 
+                {
+                    hits += b.board.checkCollision(tetromino);
+                }
+                benchSink += hits;
+            });
+        }
+
+        for (const NamedBoard& b : boards) 
+        {
+            // 重複放置同一批方塊的結果不變，每次操作的成本固定
+            Board board = b.board;
+            measure(std::string("board/placeTetromino/") + b.name, pieces.size(), [&]() 
+            {
+                for (const Tetromino& tetromino : pieces) 
+                {
+                    board.placeTetromino(tetromino);
+                }
+                benchSink += board.getRowMask(0);
+            });
+        }
+
+        // clearLines 會修改棋盤，每次操作包含一次複製 (可與 board/copy 對照)
+        NamedBoard clearBoards[] = 
+        {
+            { "none", makeStackedBoard(10, rng) },
+            { "tetris", makeTetrisBoard(12, rng) },
+        };
+        for (const NamedBoard& b : clearBoards) 
+        {
+            measure(std::string("board/clearLines/") + b.name, 1, [&]() 
+            {
+                Board board = b.board;
+                benchSink += board.clearLines().count;
+            });
+        }
+    }
+
+    void benchTetromino() 
+    {
+        measure("tetromino/getBlocks", 28, [&]() 
+        {
+            int sum = 0;
+            for (int type = 0; type < 7; ++type) 
+            {
+                Tetromino tetromino;
+                tetromino.reset(static_cast<TetrominoType>(type), 1, Board::SPAWN_COL);
+                for (int r = 0; r < 4; ++r) 
+                {
+                    const auto& blocks = tetromino.getBlocks();
+                    sum += blocks[3].first + blocks[3].second;
+                    tetromino.rotateRight();
+                }
+            }
+            benchSink += sum;
+        });
+
+        Tetromino tetromino;
+        tetromino.reset(TetrominoType::T, 1, Board::SPAWN_COL);
+        measure("tetromino/rotate+getMask", 64, [&]() 
+        {
+            int sum = 0;
+            for (int i = 0; i < 32; ++i) 
+            {
+                tetromino.rotateRight();
+                sum += tetromino.getMask().rows[0];
+                tetromino.rotateLeft();
+                sum += tetromino.getMask().maxCol;
+            }
+            benchSink += sum;
+        });
+    }
+
+    // 把一串按鍵位元組以 chunk 大小切開餵給解析器，每次操作為一個位元組
+    void benchInputStream(const std::string& name, const std::string& pattern, int chunk) 
+    {
+        std::string stream;
+        while (stream.size() < 4096) 
+        {
+            stream += pattern;
+        }
+
+        InputHandler handler;
+        auto time = std::chrono::steady_clock::now();
+        measure("input/feed/" + name, stream.size(), [&]() 
+        {
+            int events = 0;
+            for (size_t i = 0; i < stream.size(); i += chunk) 
+            {
+                int n = static_cast<int>(std::min(stream.size() - i, static_cast<size_t>(chunk)));
+                handler.feed(stream.data() + i, n, time);
+
+                KeyEvent event;
+                while (handler.pollEvent(event)) 
+                {
+                    events++;
+                }
+            }
+            benchSink += events;
+        });
+    }
+
+    // Bot 挑選落點時的批次評估：半滿的盤面上 160 個隨機落點，每個操作是一個候選盤面
+    void benchBatch() 
+    {
+        std::mt19937 rng(4242);
+        Board board = makeStackedBoard(8, rng);
+
+        static BoardBatch<Board> batch;
+        static BatchFeatures features;
+        const int CANDIDATES = 160;
+        batch.load(board, CANDIDATES);
+        for (int i = 0; i < CANDIDATES; ) 
+        {
+            Tetromino tetromino = makeTetromino(rng() % 7, rng() % 4, 0, rng() % Board::WIDTH);
+            if (board.checkCollision(tetromino)) 
+            {
+                continue;
+            }
+            tetromino.dropTo(board.getDropRow(tetromino));
+            batch.place(i++, tetromino);
+        }
+
+        const BatchKernel kernels[] = { BatchKernel::Scalar, BatchKernel::Ssse3, BatchKernel::Avx2 };
+        for (BatchKernel kernel : kernels) 
+        {
+            // CPU 不支援的核心不量測 (會退回較慢的核心，數字沒有意義)
+            if (kernel > detectBatchKernel()) 
+            {
+                continue;
+            }
+            measure(std::string("batch/evaluate/") + batchKernelName(kernel), CANDIDATES, [&]() 
+            {
+                batch.evaluate(features, kernel);
+                benchSink += features.holes[0];
+            });
+        }
+    }
+
+    void benchInput() 
+    {
+        benchInputStream("letters", "adsqead", 64);
+        benchInputStream("csi-arrows", "\033[A\033[B\033[C\033[D", 60);
+        benchInputStream("ss3-arrows", "\033OA\033OB\033OC\033OD", 60);
+        benchInputStream("mixed", "a\033[Dd\033OCs\033[1;5Aq", 64);
+        benchInputStream("split-escape", "\033[D\033[C", 1);
+    }
+
+    void benchRenderer() 
+    {
+        int fd = open("/dev/null", O_WRONLY);
+        if (fd < 0) 
+        {
+            std::perror("open /dev/null");
+            return;
+        }
+
+        std::mt19937 rng(777);
+        Renderer renderer(fd);
+
+        // 方塊在半滿的盤面上左右來回移動：差異繪製只需輸出少數格子
+        FrameSnapshot frames[16];
+        Board board = makeStackedBoard(10, rng);
+        for (int i = 0; i < 16; ++i) 
+        {
+            frames[i].board = board;
+            frames[i].tetromino = makeTetromino(2, i % 4, 2, i < 8 ? 1 + i : 16 - i);
+            frames[i].level = 3;
+            frames[i].countdown = 0;
+            frames[i].showTimings = false;
+            frames[i].versus = false;
+        }
+
+        int frame = 0;
+        measure("render/draw/moving-piece", 1, [&]() 
+        {
+            renderer.draw(frames[frame++ & 15]);
+            benchSink += renderer.getLastFrameBytes();
+        });
+
+        measure("render/draw/full-redraw", 1, [&]() 
+        {
+            renderer.invalidate();
+            renderer.draw(frames[frame++ & 15]);
+            benchSink += renderer.getLastFrameBytes();
+        });
+
+        measure("render/draw/unchanged", 1, [&]() 
+        {
+            renderer.draw(frames[0]);
+            benchSink += renderer.getLastFrameBytes();
+        });
+
+        // 對戰 + 倒數 + 計時面板：所有文字欄位每幀都重新格式化
+        FrameSnapshot versus = frames[0];
+        versus.versus = true;
+        versus.showTimings = true;
+        versus.opponentBoard = board;
+        versus.opponentTetromino = frames[8].tetromino;
+        versus.opponentLevel = 4;
+        versus.pendingGarbage = 3;
+        versus.opponentPendingGarbage = 1;
+        const LineClearResult single = { 1, 1, false };
+        measure("render/draw/versus-countdown", 1, [&]() 
+        {
+            versus.scoreManager.addScore(single);
+            versus.opponentScore = versus.scoreManager.getScore() / 2;
+            versus.countdown = 1 + (frame++ & 3);
+            renderer.draw(versus);
+            benchSink += renderer.getLastFrameBytes();
+        });
+
+        close(fd);
+    }
+
+    bool readBaseline(const char* path, std::map<std::string, Result>& baseline) 
+    {
+        FILE* file = std::fopen(path, "r");
+        if (!file) 
+        {
+            std::perror(path);
+            return false;
+        }
+
+        char line[512];
+        while (std::fgets(line, sizeof(line), file)) 
+        {
+            if (line[0] == '#' || line[0] == '\n') 
+            {
+                continue;
+            }
+            char name[256];
+            Result result;
+            result.relative = 0.0;
+            if (std::sscanf(line, "%255s %lf %lf %lf", name, &result.nsPerOp, &result.allocsPerOp, &result.relative) >= 3) 
+            {
+                result.name = name;
+                baseline[result.name] = result;
+            }
+        }
+        std::fclose(file);
+        return true;
+    }
+
+    bool writeResults(const char* path) 
+    {
+        FILE* file = std::fopen(path, "w");
+        if (!file) 
+        {
+            std::perror(path);
+            return false;
+        }
+        std::fprintf(file, "# name\tns_per_op\tallocs_per_op\trelative\n");
+        for (const Result& result : results) 
+        {
+            std::fprintf(file, "%s\t%.3f\t%.3f\t%.4f\n", result.name.c_str(), result.nsPerOp, result.allocsPerOp, result.relative);
+        }
+        std::fclose(file);
+        return true;
+    }
+
+    // 回傳退步的項目數：多配置記憶體一定算；relative 變慢只在 strictTime 時算
+    int compare(const std::map<std::string, Result>& baseline, double tolerance, bool strictTime) 
+    {
+        int regressions = 0;
+        std::printf("\n%-36s %10s %10s %8s  %s\n", "benchmark", "baseline", "current", "ratio", "allocs/op");
+        std::printf("%-36s %10s %10s\n", "", "(relative)", "(relative)");
+
+        for (const Result& result : results) 
+        {
+            if (result.name.compare(0, 12, "calibration/") == 0) 
+            {
+                continue;
+            }
+
+            auto it = baseline.find(result.name);
+            if (it == baseline.end()) 
+            {
+                std::printf("%-36s %10s %10.4f %8s  %.3f  (new)\n", result.name.c_str(), "-", result.relative, "-", result.allocsPerOp);
+                continue;
+            }
+
+            bool allocates = result.allocsPerOp > it->second.allocsPerOp + 0.001;
+            bool timed = it->second.relative > 0.0;
+            double ratio = timed ? result.relative / it->second.relative : 0.0;
+            bool slower = timed && ratio > 1.0 + tolerance;
+            if (allocates || (slower && strictTime)) 
+            {
+                regressions++;
+            }
+
+            if (timed) 
+            {
+                std::printf("%-36s %10.4f %10.4f %8.2f", result.name.c_str(), it->second.relative, result.relative, ratio);
+            }
+            else 
+            {
+                std::printf("%-36s %10s %10.4f %8s", result.name.c_str(), "-", result.relative, "-");
+            }
+            std::printf("  %.3f -> %.3f%s%s\n", it->second.allocsPerOp, result.allocsPerOp,
+                        slower ? "  SLOWER" : "", allocates ? "  MORE ALLOCS" : "");
+        }
+
+        return regressions;
+    }
+}
+
+int main(int argc, char* argv[]) 
+{
+    const char* outPath = nullptr;
+    const char* comparePath = nullptr;
+    double tolerance = 0.25;
+    bool strictTime = false;
+
+    for (int i = 1; i < argc; i += 2) 
+    {
+        if (std::strcmp(argv[i], "--strict-time") == 0) 
+        {
+            strictTime = true;
+            i--;
+        }
+        else if (i + 1 >= argc) 
+        {
+            std::fprintf(stderr, "missing value for %s\n", argv[i]);
+            return 2;
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0) 
+        {
+            filter = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--out") == 0) 
+        {
+            outPath = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--compare") == 0) 
+        {
+            comparePath = argv[i + 1];
+        }
+        else if (std::strcmp(argv[i], "--tolerance") == 0) 
+        {
+            tolerance = std::atof(argv[i + 1]);
+        }
+        else 
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    std::map<std::string, Result> baseline;
+    if (comparePath && !readBaseline(comparePath, baseline)) 
+    {
+        return 2;
+    }
+
+    std::printf("# name\tns_per_op\tallocs_per_op\trelative\n");
+    calibrate();
+    benchBoard();
+    benchTetromino();
+    benchBatch();
+    benchInput();
+    benchRenderer();
+
+    if (outPath && !writeResults(outPath)) 
+    {
+        return 2;
+    }
+
+    if (comparePath) 
+    {
+        int regressions = compare(baseline, tolerance, strictTime);
+        std::printf("\n%d regression(s) (allocs/op%s, tolerance %.0f%%)\n", regressions,
+                    strictTime ? " and relative time" : " only; SLOWER is informational without --strict-time", tolerance * 100);
+        return regressions > 0 ? 1 : 0;
+    }
+
+    return 0;
+}
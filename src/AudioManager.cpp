@@ -1,195 +1,245 @@
 #include "AudioManager.hpp"
 #include <iostream>
-#include <fstream>
 #include <cstdlib>
 #include <chrono>
 #include <thread>
-#include <unordered_map>
-#include <queue>
-#include <mutex>
-#include <condition_variable>
-#include <atomic>
 
 #ifdef _WIN32
     #include <windows.h>
     #include <mmsystem.h>
 #endif
 
-std::mutex soundMutex;
-std::queue<std::string> soundQueue;
-std::condition_variable soundCV;
-std::thread soundThread;
-std::atomic<bool> isRunning(true);
-bool isPlayingSound = false;
+// 關卡之間 BGM 交叉淡化的時間
+#define CROSSFADE_MS 800
+// 停止 BGM 時的淡出時間
+#define FADE_OUT_MS 200
 
-AudioManager::AudioManager() 
+// 取得輸出端設定：環境變數 OBLIVIONIS_AUDIO 可設為 "null"、"wav:<檔名>" 或 "pipe"
+static std::string audioSinkSpec() 
 {
-    loadConfig();
-    lastSoundTime.clear();
+    const char* spec = std::getenv("OBLIVIONIS_AUDIO");
+    return spec ? spec : "";
+}
 
-    // 只啟動一次執行緒
-    if (!soundThread.joinable()) 
+AudioManager::AudioManager()
+: currentTrack(-1),
+  preparedTrack(-1),
+  soundCooldown(std::chrono::milliseconds(500)),
+  mixer(createAudioSink(audioSinkSpec())),
+  currentDeck(-1),
+  preparedDeck(-1)
+{
+    for (int i = 0; i < Simulator::MAX_LEVEL; ++i) 
     {
-        soundThread = std::thread(&AudioManager::processSoundQueue, this);
+        levelTrack[i] = Config::NO_TRACK;
+    }
+    for (int i = 0; i < Config::SOUND_EFFECTS; ++i) 
+    {
+        soundClips[i] = -1;
     }
 }
 
 AudioManager::~AudioManager() 
 {
-    isRunning = false;
-    soundCV.notify_all();
-
-    if (soundThread.joinable()) 
+    // 先停混音器，之後才能安全地停止並釋放 BGM 串流
+    mixer.stop();
+    for (auto& deck : musicDecks) 
     {
-        soundThread.join(); 
+        deck.stop();
     }
-
-    // 移除 stopSoundEffect() 的呼叫，避免不必要地 kill aplay
-    // stopSoundEffect();
 }
 
-void AudioManager::loadConfig() 
+int AudioManager::remapTrack(const std::vector<std::string>& from, int track, const std::vector<std::string>& to) 
 {
-    std::ifstream configFile("./src/config.txt");
-    if (!configFile) 
+    if (track < 0) 
     {
-        std::cerr << "[Error] 無法讀取 config.txt\n";
-        return;
+        return -1;
     }
-
-    std::string line;
-    while (std::getline(configFile, line)) 
+    for (size_t i = 0; i < to.size(); ++i) 
     {
-        size_t delimiterPos = line.find('=');
-        if (delimiterPos != std::string::npos) 
+        if (to[i] == from[track]) 
         {
-            std::string key = line.substr(0, delimiterPos);
-            std::string value = line.substr(delimiterPos + 1);
-            configMap[key] = value;
+            return static_cast<int>(i);
         }
     }
-    configFile.close();
+    return -1;
 }
 
-void AudioManager::playSoundEffect(const std::string& key) 
+void AudioManager::configure(const Config& config) 
 {
-    if (configMap.find(key) == configMap.end()) 
+    // 播放中 / 已預先解碼的 BGM 換成新表的編號；新設定不再使用的就視為沒有
+    currentTrack = remapTrack(tracks, currentTrack, config.tracks);
+    preparedTrack = remapTrack(tracks, preparedTrack, config.tracks);
+    if (preparedTrack == -1) 
     {
-        std::cerr << "[Error] 找不到音效設定: " << key << "\n";
-        return;
+        preparedDeck = -1;
     }
-
-    auto now = std::chrono::steady_clock::now();
-    if (lastSoundTime.find(key) != lastSoundTime.end()) 
+    tracks = config.tracks;
+    for (int i = 0; i < Simulator::MAX_LEVEL; ++i) 
     {
-        double elapsed = std::chrono::duration<double>(now - lastSoundTime[key]).count();
-        if (elapsed < 0.5) return;  // **冷卻時間 0.1 秒，防止過度疊加**
+        levelTrack[i] = config.levelTrack[i];
     }
-    lastSoundTime[key] = now;
 
-    std::string filePath = configMap[key];
-    std::cout << "[Audio] 播放音效: " << filePath << "\n";
+    soundCooldown = std::chrono::milliseconds(config.soundCooldownMs);
 
-#ifdef _WIN32
-    PlaySound(TEXT(filePath.c_str()), NULL, SND_FILENAME | SND_ASYNC);
-#else
-    std::thread([filePath]() {
-        std::string command = "aplay " + filePath;
-        system(command.c_str());
-    }).detach();
-#endif
+    for (int i = 0; i < Config::SOUND_EFFECTS; ++i) 
+    {
+        if (config.soundPaths[i] == soundPaths[i]) 
+        {
+            continue;
+        }
+        soundPaths[i] = config.soundPaths[i];
+        soundClips[i] = -1;
+        if (soundPaths[i].empty()) 
+        {
+            continue;
+        }
+
+        // 啟動時一次把音效解碼進記憶體，之後播放不再讀檔
+        soundClips[i] = mixer.loadClip(soundPaths[i]);
+        if (soundClips[i] == -1) 
+        {
+            std::cerr << "[Audio] 無法載入音效 " << soundPaths[i] << " (執行中更換音效檔需重新啟動)\n";
+        }
+    }
+
+    mixer.start();
 }
 
-void AudioManager::processSoundQueue() 
+void AudioManager::playSoundEffect(SoundEffect effect) 
 {
-    while (isRunning) 
-    {
-        std::unique_lock<std::mutex> lock(soundMutex);
-        soundCV.wait(lock, []{ return !soundQueue.empty() || !isRunning; });
+    int index = static_cast<int>(effect);
 
-        if (!isRunning) break;
-
-        if (!soundQueue.empty()) 
-        {
-            isPlayingSound = true;
-            auto soundFile = soundQueue.front();
-            soundQueue.pop();
-            lock.unlock();
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastSoundTime[index] < soundCooldown) 
+    {
+        return;  // 冷卻中，防止過度疊加
+    }
+    lastSoundTime[index] = now;
 
 #ifdef _WIN32
-            // Windows 用 PlaySound
-            PlaySound(TEXT(soundFile.c_str()), NULL, SND_FILENAME | SND_SYNC);
+    if (!soundPaths[index].empty()) 
+    {
+        PlaySound(TEXT(soundPaths[index].c_str()), NULL, SND_FILENAME | SND_ASYNC);
+    }
 #else
-            // Linux/macOS 用 aplay
-            std::string command = "aplay " + soundFile;
-            int ret = system(command.c_str());
-#endif
-            isPlayingSound = false;
-        }
+    // 只是把指令推進混音器的佇列，不會 fork 也不會讀檔
+    if (soundClips[index] != -1) 
+    {
+        mixer.play(soundClips[index]);
     }
+#endif
 }
 
-// 停音效 => 可以只在程式結束時呼叫, 避免遊戲時期殺死 aplay
+// 停止所有播放中的音效 (只影響本程式的混音器)
 void AudioManager::stopSoundEffect() 
 {
-#ifndef _WIN32
-    system("pkill -9 aplay");
-#endif
+    mixer.stopAll();
 }
 
 // ---- 其它函式 (playLineClearSound, playMoveSound...) 保留 ----
 
 void AudioManager::playLineClearSound() 
 {
-    playSoundEffect("SOUND_LINE_CLEAR");
+    playSoundEffect(SoundEffect::LineClear);
 }
 
 void AudioManager::playRotateSound() 
 {
-    playSoundEffect("SOUND_ROTATE");
+    playSoundEffect(SoundEffect::Rotate);
 }
 
-void AudioManager::playMusic(int level) 
+int AudioManager::findMusic(int level) const 
 {
-    std::string key = "BGM_" + std::to_string(level);
-    if (configMap.find(key) == configMap.end()) 
+    if (level < 1 || level > Simulator::MAX_LEVEL) 
     {
-        std::cerr << "[Error] 找不到 BGM 設定: " << key << "\n";
-        return;
+        return -1;
+    }
+    return levelTrack[level - 1];
+}
+
+bool AudioManager::waitForIdleDeck(int deck) 
+{
+    // 正常情況下上一次的淡出早已結束；最多等 2 秒，避免混音器異常時卡住遊戲
+    for (int i = 0; i < 400 && !mixer.isDeckIdle(deck); ++i) 
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
     }
+    return mixer.isDeckIdle(deck);
+}
 
-    std::string bgmFile = configMap[key];
+void AudioManager::prepareMusic(int level) 
+{
+#ifndef _WIN32
+    int track = findMusic(level);
 
     // **如果 BGM 未變更，則不重新播放**
-    if (bgmFile == currentBGM) 
+    if (track == -1 || track == currentTrack) 
+    {
+        return;
+    }
+    if (preparedDeck != -1 && preparedTrack == track) 
     {
         return;
     }
 
-    stopMusic();  // **確保舊 BGM 先停止**
-    currentBGM = bgmFile;
+    int deck = currentDeck == -1 ? 0 : 1 - currentDeck;
+    if (!waitForIdleDeck(deck)) 
+    {
+        return;
+    }
 
-    std::cout << "[Audio] 播放 BGM: " << bgmFile << "\n";
+    // 解碼執行緒會先填滿 1 秒的緩衝再等待播放
+    musicDecks[deck].open(tracks[track]);
+    preparedDeck = deck;
+    preparedTrack = track;
+#endif
+}
+
+void AudioManager::playMusic(int level) 
+{
+    int track = findMusic(level);
+
+    // **如果 BGM 未變更，則不重新播放**
+    if (track == -1 || track == currentTrack) 
+    {
+        return;
+    }
 
 #ifdef _WIN32
-    PlaySound(TEXT(bgmFile.c_str()), NULL, SND_FILENAME | SND_ASYNC | SND_LOOP);
+    stopMusic();  // **確保舊 BGM 先停止**
+    PlaySound(TEXT(tracks[track].c_str()), NULL, SND_FILENAME | SND_ASYNC | SND_LOOP);
 #else
-    std::string command = "nohup mpg123 --loop -1 -q " + bgmFile + " &";
-    system(command.c_str());
+    prepareMusic(level);
+    if (preparedDeck == -1) 
+    {
+        return;
+    }
+
+    // 第一首直接開始；之後與上一首交叉淡化
+    int fadeMs = currentDeck == -1 ? 0 : CROSSFADE_MS;
+    mixer.crossfadeMusic(preparedDeck, &musicDecks[preparedDeck], fadeMs);
+    currentDeck = preparedDeck;
+    preparedDeck = -1;
+    preparedTrack = -1;
 #endif
+
+    currentTrack = track;
 }
 
 void AudioManager::stopMusic() 
 {
-    std::cout << "[Audio] 停止 BGM.\n";
 #ifdef _WIN32
     PlaySound(NULL, NULL, 0);
 #else
-    system("pkill -9 mpg123");  // **強制停止所有 mpg123 進程**
+    // 只淡出本程式的 BGM，不再 pkill 主機上其他的 mpg123
+    mixer.fadeOutMusic(FADE_OUT_MS);
+    currentDeck = -1;
 #endif
+    currentTrack = -1;
 }
 
 std::string AudioManager::getCurrentBGM() 
 {
-    return currentBGM;
+    return currentTrack == -1 ? "" : tracks[currentTrack];
 }
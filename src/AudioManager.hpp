@@ -3,31 +3,56 @@
 
 #pragma once
 #include <string>
-#include <unordered_map>
-#include <chrono> // **新增 chrono**
+#include <vector>
+#include <chrono>
+#include "Config.hpp"
+#include "AudioMixer.hpp"
+#include "MusicStream.hpp"
 
 class AudioManager 
 {
     private:
-        std::unordered_map<std::string, std::string> configMap; // 存放讀取的 config 設定
-        std::string currentBGM; // 記錄當前播放的 BGM
+        // 設定檔解析後的檔名表；遊戲中只用編號
+        std::vector<std::string> tracks;                      // 不重複的 BGM 檔名
+        int levelTrack[Simulator::MAX_LEVEL];                 // 每一關的 BGM 編號
+        std::string soundPaths[Config::SOUND_EFFECTS];
+        int currentTrack;                                     // 播放中的 BGM 編號，-1 表示沒有
+        int preparedTrack;                                    // 已預先解碼的 BGM 編號
 
-        void loadConfig(); // 讀取 config.txt
-        
-        std::unordered_map<std::string, std::chrono::steady_clock::time_point> lastSoundTime; // 避免playMoveSound()在極短時間內被多次執行
+        // 同一個音效的最短間隔，避免極短時間內多次播放
+        std::chrono::steady_clock::duration soundCooldown;
+        std::chrono::steady_clock::time_point lastSoundTime[Config::SOUND_EFFECTS];
+
+        AudioMixer mixer;                                     // 程式內的混音器 (取代每次音效 fork 一個 aplay)
+        int soundClips[Config::SOUND_EFFECTS];                // 音效編號 -> 已預先載入的混音器音效編號 (-1 表示沒有)
+
+        MusicStream musicDecks[AudioMixer::MUSIC_DECKS];      // BGM 串流 (播放中 / 預先解碼)
+        int currentDeck;                                      // 播放中的串流，-1 表示沒有
+        int preparedDeck;                                     // 已預先解碼、等待切換的串流，-1 表示沒有
+
+        // 找出關卡對應的 BGM 編號，沒有設定回傳 -1
+        int findMusic(int level) const;
+        // 設定重新載入後，以檔名找出舊編號在新表中的位置
+        static int remapTrack(const std::vector<std::string>& from, int track, const std::vector<std::string>& to);
+        // 等待混音器放開該串流
+        bool waitForIdleDeck(int deck);
 
     public:
         AudioManager();
         ~AudioManager();
 
+        // 套用設定：第一次呼叫時預先載入音效並啟動混音器；
+        // 之後 (熱重載) BGM 會在下次切歌時生效，混音器已啟動後新的音效檔需要重新啟動才會載入
+        void configure(const Config& config);
+
         void playLineClearSound();
         void playRotateSound();
-        void playSoundEffect(const std::string& key); // 播放音效
-        void playMusic(int level);
+        void playSoundEffect(SoundEffect effect); // 播放音效
+        void prepareMusic(int level); // 預先解碼下一關的 BGM (在倒數期間呼叫)
+        void playMusic(int level);    // 交叉淡化到該關的 BGM
         void stopMusic();
         void stopSoundEffect();
-        void processSoundQueue();
-        std::string getCurrentBGM(); // **新增函數來獲取當前 BGM**
+        std::string getCurrentBGM(); // 目前播放中的 BGM 檔名
 };
 
 
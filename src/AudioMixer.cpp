@@ -0,0 +1,673 @@
+#include "AudioMixer.hpp"
+#include "MusicStream.hpp"
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>    // for F_SETPIPE_SZ
+#include <pthread.h>  // for pthread_sigmask
+
+#ifdef OBLIVIONIS_ALSA
+    #include <alsa/asoundlib.h>
+#endif
+
+// ---- WAV 讀取 ----
+
+static uint32_t readLE32(const unsigned char* p) 
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint16_t readLE16(const unsigned char* p) 
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+bool loadWav(const std::string& path, PcmClip& clip) 
+{
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) 
+    {
+        std::cerr << "[Error] 無法讀取音效檔: " << path << "\n";
+        return false;
+    }
+
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 12 || std::memcmp(&bytes[0], "RIFF", 4) != 0 || std::memcmp(&bytes[8], "WAVE", 4) != 0) 
+    {
+        std::cerr << "[Error] 不是 WAV 檔: " << path << "\n";
+        return false;
+    }
+
+    int channels = 0;
+    int rate = 0;
+    int bits = 0;
+    const unsigned char* data = nullptr;
+    size_t dataSize = 0;
+
+    // 逐一走訪 chunk，找出 "fmt " 與 "data"
+    size_t offset = 12;
+    while (offset + 8 <= bytes.size()) 
+    {
+        const unsigned char* chunk = &bytes[offset];
+        size_t size = readLE32(chunk + 4);
+        size_t available = bytes.size() - offset - 8;
+        if (size > available) 
+        {
+            size = available;
+        }
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16) 
+        {
+            int format = readLE16(chunk + 8);
+            channels = readLE16(chunk + 10);
+            rate = static_cast<int>(readLE32(chunk + 12));
+            bits = readLE16(chunk + 22);
+            if (format != 1) 
+            {
+                bits = 0;   // 只支援未壓縮的 PCM
+            }
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0) 
+        {
+            data = chunk + 8;
+            dataSize = size;
+        }
+
+        offset += 8 + size + (size & 1);
+    }
+
+    if (!data || bits != 16 || (channels != 1 && channels != 2) || rate <= 0) 
+    {
+        std::cerr << "[Error] 只支援 16-bit PCM 單/雙聲道 WAV: " << path << "\n";
+        return false;
+    }
+
+    size_t sourceFrames = dataSize / (2 * channels);
+    size_t frames = static_cast<size_t>(static_cast<double>(sourceFrames) * MIXER_RATE / rate);
+    clip.samples.resize(frames * MIXER_CHANNELS);
+
+    // 取樣率不同時以線性內插重新取樣
+    for (size_t i = 0; i < frames; ++i) 
+    {
+        double source = static_cast<double>(i) * rate / MIXER_RATE;
+        size_t index = static_cast<size_t>(source);
+        double frac = source - index;
+        size_t next = index + 1 < sourceFrames ? index + 1 : index;
+
+        for (int ch = 0; ch < MIXER_CHANNELS; ++ch) 
+        {
+            int sourceChannel = channels == 1 ? 0 : ch;
+            int16_t a = static_cast<int16_t>(readLE16(data + (index * channels + sourceChannel) * 2));
+            int16_t b = static_cast<int16_t>(readLE16(data + (next * channels + sourceChannel) * 2));
+            clip.samples[i * MIXER_CHANNELS + ch] = static_cast<int16_t>(a + (b - a) * frac);
+        }
+    }
+
+    return true;
+}
+
+// ---- NullSink ----
+
+bool NullSink::open() 
+{
+    return true;
+}
+
+void NullSink::write(const int16_t*, size_t) {}
+
+bool NullSink::blocking() const 
+{
+    return false;
+}
+
+// ---- WavFileSink ----
+
+WavFileSink::WavFileSink(const std::string& filePath)
+: path(filePath),
+  file(nullptr),
+  dataBytes(0)
+{}
+
+WavFileSink::~WavFileSink() 
+{
+    close();
+}
+
+static void writeLE32(FILE* file, uint32_t value) 
+{
+    unsigned char b[4] = { static_cast<unsigned char>(value), static_cast<unsigned char>(value >> 8),
+                           static_cast<unsigned char>(value >> 16), static_cast<unsigned char>(value >> 24) };
+    std::fwrite(b, 1, 4, file);
+}
+
+static void writeLE16(FILE* file, uint16_t value) 
+{
+    unsigned char b[2] = { static_cast<unsigned char>(value), static_cast<unsigned char>(value >> 8) };
+    std::fwrite(b, 1, 2, file);
+}
+
+bool WavFileSink::open() 
+{
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) 
+    {
+        std::cerr << "[Error] 無法建立 WAV 檔: " << path << "\n";
+        return false;
+    }
+
+    // 先寫入長度為 0 的標頭，close() 時再回填
+    std::fwrite("RIFF", 1, 4, file);
+    writeLE32(file, 36);
+    std::fwrite("WAVEfmt ", 1, 8, file);
+    writeLE32(file, 16);
+    writeLE16(file, 1);
+    writeLE16(file, MIXER_CHANNELS);
+    writeLE32(file, MIXER_RATE);
+    writeLE32(file, MIXER_RATE * MIXER_CHANNELS * 2);
+    writeLE16(file, MIXER_CHANNELS * 2);
+    writeLE16(file, 16);
+    std::fwrite("data", 1, 4, file);
+    writeLE32(file, 0);
+    dataBytes = 0;
+    return true;
+}
+
+void WavFileSink::write(const int16_t* samples, size_t frames) 
+{
+    if (!file) 
+    {
+        return;
+    }
+    // WAV 為小端序，此處假設主機也是小端序 (x86 / ARM Linux)
+    std::fwrite(samples, sizeof(int16_t) * MIXER_CHANNELS, frames, file);
+    dataBytes += static_cast<uint32_t>(frames * sizeof(int16_t) * MIXER_CHANNELS);
+}
+
+void WavFileSink::close() 
+{
+    if (!file) 
+    {
+        return;
+    }
+    std::fseek(file, 4, SEEK_SET);
+    writeLE32(file, 36 + dataBytes);
+    std::fseek(file, 40, SEEK_SET);
+    writeLE32(file, dataBytes);
+    std::fclose(file);
+    file = nullptr;
+}
+
+bool WavFileSink::blocking() const 
+{
+    return false;
+}
+
+// ---- PipeSink ----
+
+PipeSink::PipeSink()
+: pipe(nullptr),
+  broken(false)
+{}
+
+PipeSink::~PipeSink() 
+{
+    close();
+}
+
+bool PipeSink::open() 
+{
+    // 緩衝 50 ms，控制延遲
+    pipe = popen("aplay -q -t raw -f S16_LE -c 2 -r 48000 --buffer-time=50000 - 2>/dev/null", "w");
+    if (!pipe) 
+    {
+        broken = true;
+        return false;
+    }
+
+#ifdef F_SETPIPE_SZ
+    // 縮小管線緩衝，避免聲音在管線裡排隊造成延遲
+    fcntl(fileno(pipe), F_SETPIPE_SZ, 4096);
+#endif
+    return true;
+}
+
+void PipeSink::write(const int16_t* samples, size_t frames) 
+{
+    if (!pipe || broken) 
+    {
+        return;
+    }
+
+    if (std::fwrite(samples, sizeof(int16_t) * MIXER_CHANNELS, frames, pipe) != frames || std::fflush(pipe) != 0) 
+    {
+        // aplay 不可用或已結束 (音訊執行緒擋住了 SIGPIPE，寫入回傳 EPIPE)：之後改由混音器自行控制節奏
+        broken = true;
+    }
+}
+
+void PipeSink::close() 
+{
+    if (pipe) 
+    {
+        pclose(pipe);
+        pipe = nullptr;
+    }
+}
+
+bool PipeSink::blocking() const 
+{
+    return !broken;
+}
+
+// ---- AlsaSink ----
+
+#ifdef OBLIVIONIS_ALSA
+AlsaSink::AlsaSink(): pcm(nullptr) {}
+
+AlsaSink::~AlsaSink() 
+{
+    close();
+}
+
+bool AlsaSink::open() 
+{
+    snd_pcm_t* handle = nullptr;
+    if (snd_pcm_open(&handle, "default", SND_PCM_STREAM_PLAYBACK, 0) < 0) 
+    {
+        return false;
+    }
+
+    // 50 ms 的裝置緩衝
+    if (snd_pcm_set_params(handle, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                           MIXER_CHANNELS, MIXER_RATE, 1, 50000) < 0) 
+    {
+        snd_pcm_close(handle);
+        return false;
+    }
+
+    pcm = handle;
+    return true;
+}
+
+void AlsaSink::write(const int16_t* samples, size_t frames) 
+{
+    snd_pcm_t* handle = static_cast<snd_pcm_t*>(pcm);
+    while (handle && frames > 0) 
+    {
+        snd_pcm_sframes_t written = snd_pcm_writei(handle, samples, frames);
+        if (written < 0) 
+        {
+            // underrun 等錯誤：嘗試恢復，失敗就放棄這一段
+            if (snd_pcm_recover(handle, static_cast<int>(written), 1) < 0) 
+            {
+                return;
+            }
+            continue;
+        }
+        samples += written * MIXER_CHANNELS;
+        frames -= static_cast<size_t>(written);
+    }
+}
+
+void AlsaSink::close() 
+{
+    if (pcm) 
+    {
+        snd_pcm_t* handle = static_cast<snd_pcm_t*>(pcm);
+        snd_pcm_drain(handle);
+        snd_pcm_close(handle);
+        pcm = nullptr;
+    }
+}
+
+bool AlsaSink::blocking() const 
+{
+    return pcm != nullptr;
+}
+#endif
+
+std::unique_ptr<AudioSink> createAudioSink(const std::string& spec) 
+{
+    if (spec == "null") 
+    {
+        return std::unique_ptr<AudioSink>(new NullSink());
+    }
+    if (spec.compare(0, 4, "wav:") == 0) 
+    {
+        return std::unique_ptr<AudioSink>(new WavFileSink(spec.substr(4)));
+    }
+#ifdef OBLIVIONIS_ALSA
+    if (spec != "pipe") 
+    {
+        return std::unique_ptr<AudioSink>(new AlsaSink());
+    }
+#endif
+    return std::unique_ptr<AudioSink>(new PipeSink());
+}
+
+// ---- AudioMixer ----
+
+AudioMixer::AudioMixer(std::unique_ptr<AudioSink> output)
+: sink(std::move(output)),
+  commands(64),
+  activeVoices(0),
+  nextSequence(0),
+  running(false)
+{
+    for (int i = 0; i < MUSIC_DECKS; ++i) 
+    {
+        decks[i].stream = nullptr;
+        decks[i].gain = 0;
+        decks[i].target = 0;
+        decks[i].step = 0;
+        deckBusy[i] = false;
+    }
+}
+
+AudioMixer::~AudioMixer() 
+{
+    stop();
+}
+
+int AudioMixer::loadClip(const std::string& path) 
+{
+    // 只能在 start() 之前載入：音訊執行緒會直接讀取 clips
+    if (running) 
+    {
+        return -1;
+    }
+
+    PcmClip clip;
+    if (!loadWav(path, clip)) 
+    {
+        return -1;
+    }
+    clips.push_back(std::move(clip));
+    return static_cast<int>(clips.size()) - 1;
+}
+
+void AudioMixer::start() 
+{
+    if (running) 
+    {
+        return;
+    }
+
+    if (!sink->open()) 
+    {
+        std::cerr << "[Error] 無法開啟音訊輸出，改為靜音\n";
+        sink.reset(new NullSink());
+        sink->open();
+    }
+
+    running = true;
+    worker = std::thread(&AudioMixer::loop, this);
+}
+
+void AudioMixer::stop() 
+{
+    if (!running) 
+    {
+        return;
+    }
+
+    running = false;
+    if (worker.joinable()) 
+    {
+        worker.join();
+    }
+    sink->close();
+}
+
+void AudioMixer::play(int clip, int gain) 
+{
+    if (clip < 0 || clip >= static_cast<int>(clips.size())) 
+    {
+        return;
+    }
+
+    Command command;
+    command.type = Command::Play;
+    command.clip = clip;
+    command.gain = gain;
+    commands.push(command);   // 佇列滿了就丟掉這個音效
+}
+
+void AudioMixer::stopAll() 
+{
+    Command command;
+    command.type = Command::StopAll;
+    command.clip = -1;
+    command.gain = 0;
+    commands.push(command);
+}
+
+void AudioMixer::crossfadeMusic(int deck, MusicStream* stream, int fadeMs) 
+{
+    // 先標記為使用中，避免指令還在佇列時就被視為閒置
+    deckBusy[deck] = true;
+
+    Command command;
+    command.type = Command::Music;
+    command.clip = deck;
+    command.gain = fadeMs * MIXER_RATE / 1000;
+    command.stream = stream;
+    while (!commands.push(command)) 
+    {
+        // BGM 切換不能遺失：佇列滿了就等混音器消化 (只會發生在關卡切換，不在遊戲迴圈的熱路徑)
+        std::this_thread::yield();
+    }
+}
+
+void AudioMixer::fadeOutMusic(int fadeMs) 
+{
+    Command command;
+    command.type = Command::Music;
+    command.clip = -1;
+    command.gain = fadeMs * MIXER_RATE / 1000;
+    command.stream = nullptr;
+    while (!commands.push(command)) 
+    {
+        std::this_thread::yield();
+    }
+}
+
+bool AudioMixer::isDeckIdle(int deck) const 
+{
+    return !deckBusy[deck];
+}
+
+void AudioMixer::fadeDeck(Deck& deck, int32_t target, int fadeFrames) 
+{
+    deck.target = target;
+    if (fadeFrames <= 0) 
+    {
+        deck.gain = target;
+        deck.step = 0;
+        return;
+    }
+    deck.step = (target - deck.gain) / fadeFrames;
+    if (deck.step == 0) 
+    {
+        deck.step = target > deck.gain ? 1 : -1;
+    }
+}
+
+void AudioMixer::applyCommands() 
+{
+    Command command;
+    while (commands.pop(command)) 
+    {
+        if (command.type == Command::StopAll) 
+        {
+            activeVoices = 0;
+            continue;
+        }
+
+        if (command.type == Command::Music) 
+        {
+            for (int i = 0; i < MUSIC_DECKS; ++i) 
+            {
+                if (i == command.clip) 
+                {
+                    decks[i].stream = command.stream;
+                    decks[i].gain = 0;
+                    fadeDeck(decks[i], 65536, command.gain);
+                }
+                else if (decks[i].stream) 
+                {
+                    fadeDeck(decks[i], 0, command.gain);
+                }
+                else 
+                {
+                    deckBusy[i] = false;
+                }
+            }
+            continue;
+        }
+
+        int slot = activeVoices;
+        if (activeVoices == MAX_VOICES) 
+        {
+            // 聲音太多：取代最早開始的那一個 (mix() 會搬動位置，陣列順序不代表先後)
+            slot = 0;
+            for (int i = 1; i < MAX_VOICES; ++i) 
+            {
+                if (voices[i].sequence < voices[slot].sequence) 
+                {
+                    slot = i;
+                }
+            }
+        }
+        else 
+        {
+            activeVoices++;
+        }
+
+        Voice& voice = voices[slot];
+        voice.clip = &clips[command.clip];
+        voice.position = 0;
+        voice.gain = command.gain;
+        voice.sequence = nextSequence++;
+    }
+}
+
+void AudioMixer::mix(int16_t* out, size_t frames) 
+{
+    int32_t accumulator[PERIOD_FRAMES * MIXER_CHANNELS];
+    std::memset(accumulator, 0, sizeof(int32_t) * frames * MIXER_CHANNELS);
+
+    for (int v = 0; v < activeVoices; ) 
+    {
+        Voice& voice = voices[v];
+        size_t remaining = voice.clip->frames() - voice.position;
+        size_t count = remaining < frames ? remaining : frames;
+        const int16_t* source = &voice.clip->samples[voice.position * MIXER_CHANNELS];
+
+        for (size_t i = 0; i < count * MIXER_CHANNELS; ++i) 
+        {
+            accumulator[i] += (source[i] * voice.gain) >> 8;
+        }
+
+        voice.position += count;
+        if (voice.position >= voice.clip->frames()) 
+        {
+            // 播完了：用最後一個補上這個位置
+            voices[v] = voices[--activeVoices];
+        }
+        else 
+        {
+            ++v;
+        }
+    }
+
+    mixMusic(accumulator, frames);
+
+    // 飽和到 16-bit 範圍
+    for (size_t i = 0; i < frames * MIXER_CHANNELS; ++i) 
+    {
+        int32_t sample = accumulator[i];
+        out[i] = static_cast<int16_t>(sample > 32767 ? 32767 : (sample < -32768 ? -32768 : sample));
+    }
+}
+
+void AudioMixer::mixMusic(int32_t* accumulator, size_t frames) 
+{
+    int16_t buffer[PERIOD_FRAMES * MIXER_CHANNELS];
+
+    for (int d = 0; d < MUSIC_DECKS; ++d) 
+    {
+        Deck& deck = decks[d];
+        if (!deck.stream) 
+        {
+            continue;
+        }
+
+        // 解碼跟不上時，缺的部分就是靜音
+        size_t count = deck.stream->read(buffer, frames);
+
+        for (size_t i = 0; i < frames; ++i) 
+        {
+            // 就算緩衝是空的，淡入淡出也照常依時間前進
+            if (deck.gain != deck.target) 
+            {
+                deck.gain += deck.step;
+                if ((deck.step > 0 && deck.gain > deck.target) || (deck.step < 0 && deck.gain < deck.target)) 
+                {
+                    deck.gain = deck.target;
+                }
+            }
+            if (i >= count) 
+            {
+                continue;
+            }
+            for (int ch = 0; ch < MIXER_CHANNELS; ++ch) 
+            {
+                accumulator[i * MIXER_CHANNELS + ch] += 
+                    static_cast<int32_t>((static_cast<int64_t>(buffer[i * MIXER_CHANNELS + ch]) * deck.gain) >> 16);
+            }
+        }
+
+        if (deck.gain == 0 && deck.target == 0) 
+        {
+            // 已完全淡出：放開串流，讓 AudioManager 可以重新使用這個播放槽
+            deck.stream = nullptr;
+            deckBusy[d] = false;
+        }
+    }
+}
+
+void AudioMixer::loop() 
+{
+    int16_t period[PERIOD_FRAMES * MIXER_CHANNELS];
+    const auto periodDuration = std::chrono::microseconds(1000000LL * PERIOD_FRAMES / MIXER_RATE);
+    auto nextPeriod = std::chrono::steady_clock::now();
+
+    // aplay 不存在或已結束時寫入管線會收到 SIGPIPE：只在音訊執行緒擋住，讓 write 回傳 EPIPE，
+    // 不更動整個行程的訊號處理
+    sigset_t pipeSignal;
+    sigemptyset(&pipeSignal);
+    sigaddset(&pipeSignal, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeSignal, nullptr);
+
+    while (running) 
+    {
+        applyCommands();
+        mix(period, PERIOD_FRAMES);
+        sink->write(period, PERIOD_FRAMES);
+
+        // 寫入不會阻塞的輸出端 (Null/WAV) 由時鐘控制節奏，維持與實際時間同步
+        if (!sink->blocking()) 
+        {
+            nextPeriod += periodDuration;
+            auto now = std::chrono::steady_clock::now();
+            if (nextPeriod < now) 
+            {
+                nextPeriod = now;
+            }
+            std::this_thread::sleep_until(nextPeriod);
+        }
+    }
+}
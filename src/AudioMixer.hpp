@@ -0,0 +1,193 @@
+#ifndef AUDIOMIXER
+#define AUDIOMIXER
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "RingBuffer.hpp"
+
+class MusicStream;
+
+// 混音器輸出格式：48 kHz、雙聲道、16-bit
+static const int MIXER_RATE = 48000;
+static const int MIXER_CHANNELS = 2;
+
+// 已解碼、已轉成混音器格式的 PCM (交錯的雙聲道樣本)
+struct PcmClip 
+{
+    std::vector<int16_t> samples;
+
+    size_t frames() const 
+    {
+        return samples.size() / MIXER_CHANNELS;
+    }
+};
+
+// 讀取 16-bit PCM WAV，轉成混音器格式 (單聲道複製成雙聲道、線性內插重新取樣)
+bool loadWav(const std::string& path, PcmClip& clip);
+
+// ---- 輸出端 (可替換) ----
+
+class AudioSink 
+{
+    public:
+        virtual ~AudioSink() {}
+
+        virtual bool open() = 0;
+        // 寫出 frames 個交錯的雙聲道樣本
+        virtual void write(const int16_t* samples, size_t frames) = 0;
+        virtual void close() {}
+
+        // 寫入時會依播放速度阻塞 (如 ALSA)；否則由混音器自行以時鐘控制節奏
+        virtual bool blocking() const = 0;
+};
+
+// 丟棄所有聲音 (測試、無頭模擬)
+class NullSink : public AudioSink 
+{
+    public:
+        bool open();
+        void write(const int16_t* samples, size_t frames);
+        bool blocking() const;
+};
+
+// 寫成 WAV 檔 (測試時可比對實際混出的聲音)
+class WavFileSink : public AudioSink 
+{
+    private:
+        std::string path;
+        FILE* file;
+        uint32_t dataBytes;
+
+    public:
+        explicit WavFileSink(const std::string& path);
+        ~WavFileSink();
+
+        bool open();
+        void write(const int16_t* samples, size_t frames);
+        void close();
+        bool blocking() const;
+};
+
+// 經由管線交給單一個常駐的 aplay 行程播放 (整場遊戲只開一次)，沒有 ALSA 開發檔時使用
+class PipeSink : public AudioSink 
+{
+    private:
+        FILE* pipe;
+        bool broken;
+
+    public:
+        PipeSink();
+        ~PipeSink();
+
+        bool open();
+        void write(const int16_t* samples, size_t frames);
+        void close();
+        bool blocking() const;
+};
+
+#ifdef OBLIVIONIS_ALSA
+// 直接寫入 ALSA PCM 裝置
+class AlsaSink : public AudioSink 
+{
+    private:
+        void* pcm;   // snd_pcm_t*，避免在標頭檔引入 alsa/asoundlib.h
+
+    public:
+        AlsaSink();
+        ~AlsaSink();
+
+        bool open();
+        void write(const int16_t* samples, size_t frames);
+        void close();
+        bool blocking() const;
+};
+#endif
+
+// 依名稱建立輸出端："null"、"wav:<檔名>"、"pipe"，其餘 (或空字串) 為預設的實體播放
+std::unique_ptr<AudioSink> createAudioSink(const std::string& spec);
+
+// ---- 混音器 ----
+
+// 單一音訊執行緒以固定週期混合所有播放中的聲音並交給輸出端。
+// 遊戲執行緒只把指令推進無鎖佇列：不配置記憶體、不上鎖、不做系統呼叫
+class AudioMixer 
+{
+    public:
+        static const int PERIOD_FRAMES = 480;   // 每個混音週期 10 ms
+        static const int MAX_VOICES = 16;       // 同時播放的聲音上限
+        static const int MUSIC_DECKS = 2;       // BGM 播放槽：一個播放中、一個預先解碼下一首
+
+    private:
+        struct Command 
+        {
+            enum Type { Play, StopAll, Music } type;
+            int clip;      // Play：音效編號；Music：要淡入的播放槽 (-1 表示全部淡出)
+            int gain;      // Play：Q8 音量 (256 = 原音量)；Music：淡入淡出的 frame 數
+            MusicStream* stream;
+        };
+
+        struct Voice 
+        {
+            const PcmClip* clip;
+            size_t position;   // 目前播放到的 frame
+            int gain;
+            uint64_t sequence; // 開始播放的順序，聲音太多時取代最小的
+        };
+
+        // BGM 播放槽：以 Q16 音量做線性淡入淡出，淡出到 0 後就放開串流
+        struct Deck 
+        {
+            MusicStream* stream;
+            int32_t gain;      // 目前音量 (65536 = 原音量)
+            int32_t target;    // 目標音量
+            int32_t step;      // 每個 frame 的變化量
+        };
+
+        std::unique_ptr<AudioSink> sink;
+        std::vector<PcmClip> clips;        // 啟動時預先載入，之後唯讀
+        RingBuffer<Command> commands;
+        Voice voices[MAX_VOICES];
+        int activeVoices;
+        uint64_t nextSequence;
+        Deck decks[MUSIC_DECKS];
+        std::atomic<bool> deckBusy[MUSIC_DECKS];   // 混音器是否還在讀取該播放槽的串流
+
+        std::thread worker;
+        std::atomic<bool> running;
+
+        void loop();
+        void applyCommands();
+        void mix(int16_t* out, size_t frames);
+        void mixMusic(int32_t* accumulator, size_t frames);
+        void fadeDeck(Deck& deck, int32_t target, int fadeFrames);
+
+    public:
+        explicit AudioMixer(std::unique_ptr<AudioSink> sink);
+        ~AudioMixer();
+
+        // 啟動前預先載入音效，回傳編號 (失敗回傳 -1)
+        int loadClip(const std::string& path);
+
+        void start();
+        void stop();
+
+        // 遊戲執行緒：播放 / 停止所有音效
+        void play(int clip, int gain = 256);
+        void stopAll();
+
+        // BGM：把 stream 放進 deck 並在 fadeMs 內淡入，其他播放槽同時淡出 (交叉淡化)
+        void crossfadeMusic(int deck, MusicStream* stream, int fadeMs);
+        // BGM：所有播放槽在 fadeMs 內淡出
+        void fadeOutMusic(int fadeMs);
+        // 混音器是否已不再讀取該播放槽 (此時才能重新開啟它的串流)
+        bool isDeckIdle(int deck) const;
+};
+
+#endif
@@ -1,42 +1,122 @@
 #include "Board.hpp"
-#include <algorithm>
+#include <cstring>
 
-Board::Board() 
+template <int W, int H>
+const int BasicBoard<W, H>::WIDTH;
+
+template <int W, int H>
+const int BasicBoard<W, H>::HEIGHT;
+
+template <int W, int H>
+const typename BasicBoard<W, H>::Row BasicBoard<W, H>::FULL_ROW;
+
+template <int W, int H>
+const int BasicBoard<W, H>::SPAWN_COL;
+
+template <int W, int H>
+BasicBoard<W, H>::BasicBoard() 
 {
     // 初始化：整個棋盤都是 0 (空)
-    grid.resize(HEIGHT, std::vector<int>(WIDTH, 0));
+    std::memset(rows, 0, sizeof(rows));
+    std::memset(colors, 0, sizeof(colors));
+    std::memset(heights, 0, sizeof(heights));
 }
 
-Board::~Board() {}
-
-bool Board::checkCollision(const Tetromino& tetromino) const 
+template <int W, int H>
+bool BasicBoard<W, H>::checkCollision(const Tetromino& tetromino) const 
 {
-    auto blocks = tetromino.getBlocks();
+    const TetrominoMask& mask = tetromino.getMask();
     auto pos = tetromino.getPosition();
 
-    for (auto &block : blocks) 
+    // 超出左右邊界
+    int left = pos.second + mask.minCol;
+    if (left < 0 || pos.second + mask.maxCol >= WIDTH) 
     {
-        int row = pos.first + block.first;
-        int col = pos.second + block.second;
+        return true;
+    }
+
+    // 超出上下邊界
+    if (pos.first + mask.minRow < 0 || pos.first + mask.maxRow >= HEIGHT) 
+    {
+        return true;
+    }
 
-        // 超出邊界
-        if (row < 0 || row >= HEIGHT || col < 0 || col >= WIDTH) 
+    // 逐行把方塊遮罩平移到所在欄位，與棋盤遮罩做 AND，任一位元重疊即為碰撞
+    for (int i = mask.minRow; i <= mask.maxRow; ++i) 
+    {
+        if (rows[pos.first + i] & (static_cast<Row>(mask.rows[i]) << left)) 
         {
             return true;
         }
+    }
+    return false;
+}
 
-        // 該格子已經有方塊(顏色 != 0)
-        if (grid[row][col] != 0) 
+template <int W, int H>
+typename BasicBoard<W, H>::RowSet BasicBoard<W, H>::getFreeRows(const TetrominoMask& mask, int col) const 
+{
+    int left = col + mask.minCol;
+    if (left < 0 || col + mask.maxCol >= WIDTH) 
+    {
+        return 0;
+    }
+
+    // 只有方塊上下都不超出棋盤的 row 才需要檢查 (minRow 不為負，從第 0 行開始即可)
+    RowSet free = 0;
+    for (int row = 0; row + mask.maxRow < HEIGHT; ++row) 
+    {
+        Row hit = 0;
+        for (int i = mask.minRow; i <= mask.maxRow; ++i) 
         {
-            return true;
+            hit |= rows[row + i] & (static_cast<Row>(mask.rows[i]) << left);
+        }
+        if (!hit) 
+        {
+            free |= static_cast<RowSet>(1) << row;
         }
     }
-    return false;
+    return free;
+}
+
+template <int W, int H>
+int BasicBoard<W, H>::getDropRow(const Tetromino& tetromino) const 
+{
+    const TetrominoMask& mask = tetromino.getMask();
+    auto pos = tetromino.getPosition();
+    int left = pos.second + mask.minCol;
+
+    // 每一欄能往下到的最低位置：方塊在該欄的最下面一格要停在天際線之上
+    int drop = HEIGHT;
+    for (int j = 0; j <= mask.maxCol - mask.minCol; ++j) 
+    {
+        if (mask.bottom[j] >= 0) 
+        {
+            int row = HEIGHT - 1 - heights[left + j] - mask.bottom[j];
+            drop = row < drop ? row : drop;
+        }
+    }
+
+    if (drop >= pos.first) 
+    {
+        return drop;
+    }
+
+    // 方塊已經在某一欄的最高方塊之下 (滑進懸空處)：天際線不能代表下方的空格，
+    // 改由不碰撞的 row 位元表找出目前位置往下第一個碰撞的 row
+    RowSet blocked = static_cast<RowSet>(~(getFreeRows(mask, pos.second) >> pos.first));
+    return pos.first + __builtin_ctzll(blocked) - 1;
 }
 
-void Board::placeTetromino(const Tetromino& tetromino) 
+template <int W, int H>
+int BasicBoard<W, H>::getColumnHeight(int col) const 
 {
-    auto blocks = tetromino.getBlocks();
+    return heights[col];
+}
+
+template <int W, int H>
+void BasicBoard<W, H>::placeTetromino(const Tetromino& tetromino) 
+{
+    const auto& blocks = tetromino.getBlocks();
     auto pos = tetromino.getPosition();
     // 取得該方塊的顏色
     int color = tetromino.getColor(); 
@@ -48,48 +128,143 @@ void Board::placeTetromino(const Tetromino& tetromino)
 
         if (row >= 0 && row < HEIGHT && col >= 0 && col < WIDTH) 
         {
-            // 放入該方塊的顏色
-            grid[row][col] = color;
+            // 設定佔用位元，並放入該方塊的顏色
+            rows[row] |= static_cast<Row>(static_cast<Row>(1) << col);
+            colors[row][col] = static_cast<uint8_t>(color);
+            if (HEIGHT - row > heights[col]) 
+            {
+                heights[col] = static_cast<uint8_t>(HEIGHT - row);
+            }
+        }
+    }
+}
+
+template <int W, int H>
+LineClearResult BasicBoard<W, H>::clearLines() 
+{
+    LineClearResult result = {0, 0, false};
+    Row remaining = 0;
+
+    // 由下往上掃描：未滿的行搬到 dst，滿行直接跳過，每行最多搬一次
+    int dst = HEIGHT - 1;
+    for (int src = HEIGHT - 1; src >= 0; --src) 
+    {
+        // 整行填滿 => 遮罩等於 FULL_ROW
+        if (rows[src] == FULL_ROW) 
+        {
+            result.clearedRows |= static_cast<uint64_t>(1) << src;
+            result.count++;
+            continue;
         }
+
+        if (dst != src) 
+        {
+            rows[dst] = rows[src];
+            std::memcpy(colors[dst], colors[src], sizeof(colors[0]));
+        }
+        remaining |= rows[dst];
+        --dst;
+    }
+
+    // 最上面被騰出的行清空
+    if (result.count > 0) 
+    {
+        std::memset(rows, 0, result.count * sizeof(rows[0]));
+        std::memset(colors, 0, result.count * sizeof(colors[0]));
+        rebuildHeights();
     }
+
+    result.perfectClear = (result.count > 0 && remaining == 0);
+    return result;
 }
 
-int Board::clearLines() 
+template <int W, int H>
+bool BasicBoard<W, H>::addGarbage(int lines, int holeCol, int color) 
 {
-    int linesCleared = 0;
+    if (lines <= 0) 
+    {
+        return true;
+    }
+    if (lines > HEIGHT) 
+    {
+        lines = HEIGHT;
+    }
 
-    for (int r = 0; r < HEIGHT; ++r) 
+    // 被推出盤面的行只要有任何方塊就是頂出
+    bool fits = true;
+    for (int r = 0; r < lines; ++r) 
     {
-        bool isFull = true;
+        if (rows[r]) 
+        {
+            fits = false;
+        }
+    }
+
+    std::memmove(rows, rows + lines, (HEIGHT - lines) * sizeof(rows[0]));
+    std::memmove(colors, colors + lines, (HEIGHT - lines) * sizeof(colors[0]));
 
+    const Row garbage = static_cast<Row>(FULL_ROW & ~(static_cast<Row>(1) << holeCol));
+    for (int r = HEIGHT - lines; r < HEIGHT; ++r) 
+    {
+        rows[r] = garbage;
         for (int c = 0; c < WIDTH; ++c) 
         {
-            if (grid[r][c] == 0) 
-            {
-                isFull = false;
-                break;
-            }
+            colors[r][c] = c == holeCol ? 0 : static_cast<uint8_t>(color);
         }
+    }
 
-        if (isFull) 
-        {
-            linesCleared++;
+    if (!fits) 
+    {
+        rebuildHeights();
+        return false;
+    }
 
-            // 把該行上方的內容往下搬
-            for (int rowToMove = r; rowToMove > 0; --rowToMove) 
-            {
-                grid[rowToMove] = grid[rowToMove - 1];
-            }
+    // 每一欄整個往上移 lines 格；空欄在垃圾行上也有方塊 (洞所在的欄除外)
+    for (int c = 0; c < WIDTH; ++c) 
+    {
+        if (heights[c] > 0) 
+        {
+            heights[c] = static_cast<uint8_t>(heights[c] + lines);
+        }
+        else if (c != holeCol) 
+        {
+            heights[c] = static_cast<uint8_t>(lines);
+        }
+    }
+    return true;
+}
 
-            // 最上面那行清空
-            grid[0] = std::vector<int>(WIDTH, 0);
+template <int W, int H>
+void BasicBoard<W, H>::rebuildHeights() 
+{
+    // 被消除的行可能正好是某欄最上面的方塊，這時新的高度要看下方的洞，不能直接減去消行數；
+    // 由上往下掃描，每一欄第一次出現方塊的那一行就是它的高度
+    std::memset(heights, 0, sizeof(heights));
+    Row seen = 0;
+    for (int r = 0; r < HEIGHT && seen != FULL_ROW; ++r) 
+    {
+        Row fresh = static_cast<Row>(rows[r] & ~seen);
+        seen |= rows[r];
+        while (fresh) 
+        {
+            heights[__builtin_ctzll(fresh)] = static_cast<uint8_t>(HEIGHT - r);
+            fresh &= static_cast<Row>(fresh - 1);
         }
     }
+}
 
-    return linesCleared;
+template <int W, int H>
+int BasicBoard<W, H>::getCell(int row, int col) const 
+{
+    return colors[row][col];
 }
 
-const std::vector<std::vector<int>>& Board::getGrid() const 
+template <int W, int H>
+typename BasicBoard<W, H>::Row BasicBoard<W, H>::getRowMask(int row) const 
 {
-    return grid;
+    return rows[row];
 }
+
+#define BOARD_INSTANTIATE(w, h) template class BasicBoard<w, h>;
+BOARD_VARIANTS(BOARD_INSTANTIATE)
+#undef BOARD_INSTANTIATE
@@ -3,33 +3,104 @@
 
 #pragma once
 
-#include <vector>
+#include <cstdint>
+#include <type_traits>
 #include "Tetromino.hpp"
 
-class Board 
+// 一次消行的結果，供計分與畫面效果使用，不必再重新掃描棋盤
+struct LineClearResult 
 {
-    private:
-        // 二維容器存放方塊狀態：0 表示空，非 0 表示有方塊 (可用作顏色/ID)
-        std::vector<std::vector<int>> grid;
+    uint64_t clearedRows;   // 被消除的行：第 r 個位元為 1 表示原本的第 r 行被消除
+    int count;              // 消除的行數
+    bool perfectClear;      // 消行後棋盤是否完全清空
+};
+
+// 所有有編譯的棋盤尺寸 (寬, 高)：Board.cpp、BoardBatch.cpp、Simulator.cpp 與 Bot.cpp 為每一種各自實體化一份，
+// 工具程式也以此表對應命令列指定的尺寸。新增尺寸只要加在這裡
+#define BOARD_VARIANTS(X) \
+    X(10, 20)   /* 標準 */ \
+    X(10, 40)   /* 上方 20 行緩衝區 */ \
+    X(4, 20)    /* 窄井 */ \
+    X(32, 20)   /* 寬盤面 */ \
+    X(64, 20)
+
+// 寬 W、高 H 的棋盤。尺寸是模板參數，碰撞、落點與消行的迴圈邊界、
+// 逐行遮罩與行集合的位元寬度都在編譯期決定，每一種尺寸各有一份特化的程式碼，呼叫時不檢查尺寸
+template <int W, int H>
+class BasicBoard 
+{
+    static_assert(W >= 4 && W <= 64, "棋盤寬度必須在 4 ~ 64 之間 (一行一個整數遮罩，且要放得下 I)");
+    static_assert(H >= 4 && H <= 63, "棋盤高度必須在 4 ~ 63 之間 (行集合是一個整數，還要多一個位元給底部的牆)");
 
     public:
-        Board();
-        ~Board();
+        static const int WIDTH = W;    // 棋盤寬度
+        static const int HEIGHT = H;   // 棋盤高度
+
+        // 一行的佔用遮罩：放得下 WIDTH 個位元的最小整數
+        typedef typename std::conditional<(W <= 16), uint16_t,
+                typename std::conditional<(W <= 32), uint32_t, uint64_t>::type>::type Row;
+
+        // 行集合 (getFreeRows 的結果)：第 r 個位元對應第 r 行
+        typedef typename std::conditional<(H < 32), uint32_t, uint64_t>::type RowSet;
+
+        // 一整行填滿時的位元遮罩 (低 WIDTH 個位元全為 1)
+        static const Row FULL_ROW = static_cast<Row>(static_cast<Row>(~static_cast<Row>(0)) >> (8 * sizeof(Row) - W));
+
+        // 新方塊出現的欄：標準盤面為第 4 欄；窄盤面要讓水平的 I (4 格) 放得下
+        static const int SPAWN_COL = W / 2 - 1 < W - 4 ? W / 2 - 1 : W - 4;
+
+    private:
+        // 佔用位元盤：每一行一個遮罩，第 c 個位元為 1 表示 (row, c) 有方塊
+        Row rows[HEIGHT];
+        // 顏色平面：0 表示空，非 0 表示該格方塊的顏色編號
+        uint8_t colors[HEIGHT][WIDTH];
+        // 天際線：每一欄最上面方塊的高度 (HEIGHT - 最上面方塊的 row，空欄為 0)，
+        // 放置與消行時增量維護，這一欄在它上面的格子全都是空的
+        uint8_t heights[WIDTH];
+
+        // 消行後依逐行遮罩重建天際線
+        void rebuildHeights();
 
-        static const int WIDTH = 10;   // 棋盤寬度
-        static const int HEIGHT = 20;  // 棋盤高度
+    public:
+        BasicBoard();
 
         // 檢查放置中的方塊是否碰撞到牆壁或其他方塊
         bool checkCollision(const Tetromino& tetromino) const;
 
+        // 一次算出某個旋轉狀態的方塊放在第 col 欄時，哪些 row 不會碰撞：
+        // 第 r 個位元為 1 表示位置 (r, col) 與 checkCollision() 的結果為 false (只涵蓋 r >= 0)
+        RowSet getFreeRows(const TetrominoMask& mask, int col) const;
+
+        // 方塊從目前位置直接落下會停在哪一行 (回傳 row，方塊目前位置必須不碰撞)。
+        // 方塊在天際線之上時只查表 (每欄一次)；被壓在懸空處下方時改以逐行遮罩往下找
+        int getDropRow(const Tetromino& tetromino) const;
+
+        // 取得第 col 欄的高度 (0 ~ HEIGHT)
+        int getColumnHeight(int col) const;
+
         // 將方塊放置到棋盤上
         void placeTetromino(const Tetromino& tetromino);
 
-        // 檢查並消除已填滿的一行，回傳消除的行數
-        int clearLines();
+        // 以單次由下往上的壓縮消除所有已填滿的行，回傳消行結果
+        LineClearResult clearLines();
+
+        // 對戰：從底部推入 lines 行垃圾 (除了 holeCol 之外全滿)，整個盤面往上移；
+        // 最上面有方塊被推出盤面時回傳 false (頂出)
+        bool addGarbage(int lines, int holeCol, int color);
+
+        // 取得某一格的顏色 (0 表示空)，用於繪製或調試
+        int getCell(int row, int col) const;
 
-        // 取得棋盤內部狀態，用於繪製或調試
-        const std::vector<std::vector<int>>& getGrid() const;
+        // 取得某一行的佔用遮罩
+        Row getRowMask(int row) const;
 };
 
-# endif
\ No newline at end of file
+// 遊戲本體 (畫面、重播、對戰、觀戰、存檔) 使用的標準 10 x 20 棋盤
+typedef BasicBoard<10, 20> Board;
+
+// 定義在 Board.cpp，只實體化 BOARD_VARIANTS 列出的尺寸
+#define BOARD_EXTERN_TEMPLATE(w, h) extern template class BasicBoard<w, h>;
+BOARD_VARIANTS(BOARD_EXTERN_TEMPLATE)
+#undef BOARD_EXTERN_TEMPLATE
+
+# endif
@@ -0,0 +1,364 @@
+#include "BoardBatch.hpp"
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BOARDBATCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // 不依賴 -mpopcnt 的位元計數 (棋盤一行只有 WIDTH 個位元)
+    inline int popcount(uint32_t x)
+    {
+        x = x - ((x >> 1) & 0x55555555u);
+        x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+        x = (x + (x >> 4)) & 0x0F0F0F0Fu;
+        return static_cast<int>((x * 0x01010101u) >> 24);
+    }
+
+    // 寬度超過 32 欄的棋盤
+    inline int popcount(uint64_t x)
+    {
+        x = x - ((x >> 1) & 0x5555555555555555ull);
+        x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+        return static_cast<int>((x * 0x0101010101010101ull) >> 56);
+    }
+
+    const int CAPACITY = BatchFeatures::CAPACITY;
+
+#ifdef BOARDBATCH_X86
+    // 向量核心與純量版逐行做同樣的位元運算，只是一次處理 16 (AVX2) 或 8 (SSSE3) 個候選：
+    // 每個候選是一個 16-bit lane，popcount 以 pshufb 查 4-bit 表後把相鄰兩個位元組相加。
+    // 填滿的行整行遮掉 (等同已消除)，不必搬動其他行；各項特徵最多 WIDTH * HEIGHT，不會超出 16 位元
+
+    __attribute__((target("avx2")))
+    inline __m256i popcount16(__m256i x, __m256i table, __m256i nibble, __m256i ones)
+    {
+        __m256i lo = _mm256_and_si256(x, nibble);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+        __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(table, lo), _mm256_shuffle_epi8(table, hi));
+        return _mm256_maddubs_epi16(bytes, ones);
+    }
+
+    __attribute__((target("avx2")))
+    void evaluateAvx2(const uint16_t* rows, int height, int padded, uint16_t full, uint16_t rightWall, BatchFeatures& out)
+    {
+        const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                               0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i nibble = _mm256_set1_epi8(0x0F);
+        const __m256i ones = _mm256_set1_epi8(1);
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i fullRow = _mm256_set1_epi16(static_cast<short>(full));
+        const __m256i inner = _mm256_set1_epi16(static_cast<short>(full >> 1));
+        const __m256i leftWall = _mm256_set1_epi16(1);
+        const __m256i rightWallMask = _mm256_set1_epi16(static_cast<short>(rightWall));
+        const __m256i walls = _mm256_or_si256(leftWall, rightWallMask);
+
+        for (int i = 0; i < padded; i += 16)
+        {
+            __m256i seen = zero;
+            __m256i aggregateHeight = zero;
+            __m256i holes = zero;
+            __m256i bumpiness = zero;
+            __m256i wells = zero;
+            __m256i transitions = zero;
+            __m256i lines = zero;
+
+            for (int r = 0; r < height; ++r)
+            {
+                __m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows + r * CAPACITY + i));
+                __m256i cleared = _mm256_cmpeq_epi16(row, fullRow);
+                lines = _mm256_sub_epi16(lines, cleared);
+                row = _mm256_andnot_si256(cleared, row);
+                seen = _mm256_or_si256(seen, row);
+
+                __m256i height16 = popcount16(seen, table, nibble, ones);
+                __m256i hole16 = popcount16(_mm256_andnot_si256(row, seen), table, nibble, ones);
+                __m256i bump16 = popcount16(_mm256_and_si256(_mm256_xor_si256(seen, _mm256_srli_epi16(seen, 1)), inner),
+                                            table, nibble, ones);
+                __m256i well16 = popcount16(_mm256_andnot_si256(seen, _mm256_and_si256(fullRow, _mm256_and_si256(
+                                                _mm256_or_si256(_mm256_slli_epi16(seen, 1), leftWall),
+                                                _mm256_or_si256(_mm256_srli_epi16(seen, 1), rightWallMask)))),
+                                            table, nibble, ones);
+                aggregateHeight = _mm256_add_epi16(aggregateHeight, _mm256_andnot_si256(cleared, height16));
+                holes = _mm256_add_epi16(holes, _mm256_andnot_si256(cleared, hole16));
+                bumpiness = _mm256_add_epi16(bumpiness, _mm256_andnot_si256(cleared, bump16));
+                wells = _mm256_add_epi16(wells, _mm256_andnot_si256(cleared, well16));
+
+                // 被消除的行已經遮成 0，與空行一樣不計
+                __m256i empty = _mm256_cmpeq_epi16(row, zero);
+                __m256i trans16 = _mm256_add_epi16(
+                    popcount16(_mm256_and_si256(_mm256_xor_si256(row, _mm256_srli_epi16(row, 1)), inner), table, nibble, ones),
+                    popcount16(_mm256_andnot_si256(row, walls), table, nibble, ones));
+                transitions = _mm256_add_epi16(transitions, _mm256_andnot_si256(empty, trans16));
+            }
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.aggregateHeight + i), aggregateHeight);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.holes + i), holes);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.bumpiness + i), bumpiness);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.wells + i), wells);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.rowTransitions + i), transitions);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.lines + i), lines);
+        }
+    }
+
+    __attribute__((target("ssse3")))
+    inline __m128i popcount16(__m128i x, __m128i table, __m128i nibble, __m128i ones)
+    {
+        __m128i lo = _mm_and_si128(x, nibble);
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+        __m128i bytes = _mm_add_epi8(_mm_shuffle_epi8(table, lo), _mm_shuffle_epi8(table, hi));
+        return _mm_maddubs_epi16(bytes, ones);
+    }
+
+    __attribute__((target("ssse3")))
+    void evaluateSsse3(const uint16_t* rows, int height, int padded, uint16_t full, uint16_t rightWall, BatchFeatures& out)
+    {
+        const __m128i table = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m128i nibble = _mm_set1_epi8(0x0F);
+        const __m128i ones = _mm_set1_epi8(1);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i fullRow = _mm_set1_epi16(static_cast<short>(full));
+        const __m128i inner = _mm_set1_epi16(static_cast<short>(full >> 1));
+        const __m128i leftWall = _mm_set1_epi16(1);
+        const __m128i rightWallMask = _mm_set1_epi16(static_cast<short>(rightWall));
+        const __m128i walls = _mm_or_si128(leftWall, rightWallMask);
+
+        for (int i = 0; i < padded; i += 8)
+        {
+            __m128i seen = zero;
+            __m128i aggregateHeight = zero;
+            __m128i holes = zero;
+            __m128i bumpiness = zero;
+            __m128i wells = zero;
+            __m128i transitions = zero;
+            __m128i lines = zero;
+
+            for (int r = 0; r < height; ++r)
+            {
+                __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + r * CAPACITY + i));
+                __m128i cleared = _mm_cmpeq_epi16(row, fullRow);
+                lines = _mm_sub_epi16(lines, cleared);
+                row = _mm_andnot_si128(cleared, row);
+                seen = _mm_or_si128(seen, row);
+
+                __m128i height16 = popcount16(seen, table, nibble, ones);
+                __m128i hole16 = popcount16(_mm_andnot_si128(row, seen), table, nibble, ones);
+                __m128i bump16 = popcount16(_mm_and_si128(_mm_xor_si128(seen, _mm_srli_epi16(seen, 1)), inner),
+                                            table, nibble, ones);
+                __m128i well16 = popcount16(_mm_andnot_si128(seen, _mm_and_si128(fullRow, _mm_and_si128(
+                                                _mm_or_si128(_mm_slli_epi16(seen, 1), leftWall),
+                                                _mm_or_si128(_mm_srli_epi16(seen, 1), rightWallMask)))),
+                                            table, nibble, ones);
+                aggregateHeight = _mm_add_epi16(aggregateHeight, _mm_andnot_si128(cleared, height16));
+                holes = _mm_add_epi16(holes, _mm_andnot_si128(cleared, hole16));
+                bumpiness = _mm_add_epi16(bumpiness, _mm_andnot_si128(cleared, bump16));
+                wells = _mm_add_epi16(wells, _mm_andnot_si128(cleared, well16));
+
+                __m128i empty = _mm_cmpeq_epi16(row, zero);
+                __m128i trans16 = _mm_add_epi16(
+                    popcount16(_mm_and_si128(_mm_xor_si128(row, _mm_srli_epi16(row, 1)), inner), table, nibble, ones),
+                    popcount16(_mm_andnot_si128(row, walls), table, nibble, ones));
+                transitions = _mm_add_epi16(transitions, _mm_andnot_si128(empty, trans16));
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out.aggregateHeight + i), aggregateHeight);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out.holes + i), holes);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out.bumpiness + i), bumpiness);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out.wells + i), wells);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out.rowTransitions + i), transitions);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out.lines + i), lines);
+        }
+    }
+#endif
+
+    template <class BoardT>
+    void evaluateScalar(const typename BoardT::Row* rows, int count, BatchFeatures& out)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            BoardFeatures features = BoardBatch<BoardT>::countFeatures(rows + i, CAPACITY);
+            out.aggregateHeight[i] = static_cast<uint16_t>(features.aggregateHeight);
+            out.holes[i] = static_cast<uint16_t>(features.holes);
+            out.bumpiness[i] = static_cast<uint16_t>(features.bumpiness);
+            out.wells[i] = static_cast<uint16_t>(features.wells);
+            out.rowTransitions[i] = static_cast<uint16_t>(features.rowTransitions);
+            out.lines[i] = static_cast<uint16_t>(features.lines);
+        }
+    }
+
+    // 16 欄以內的棋盤：一行剛好是一個 16-bit lane，可以用向量核心
+    template <class BoardT>
+    void evaluateRows(const typename BoardT::Row* rows, int count, int padded, BatchFeatures& out, BatchKernel kernel,
+                      std::true_type)
+    {
+#ifdef BOARDBATCH_X86
+        const uint16_t rightWall = static_cast<uint16_t>(1u << (BoardT::WIDTH - 1));
+        if (kernel == BatchKernel::Avx2)
+        {
+            evaluateAvx2(rows, BoardT::HEIGHT, padded, BoardT::FULL_ROW, rightWall, out);
+            return;
+        }
+        if (kernel == BatchKernel::Ssse3)
+        {
+            evaluateSsse3(rows, BoardT::HEIGHT, padded, BoardT::FULL_ROW, rightWall, out);
+            return;
+        }
+#else
+        (void)padded;
+        (void)kernel;
+#endif
+        evaluateScalar<BoardT>(rows, count, out);
+    }
+
+    // 更寬的棋盤只有純量版
+    template <class BoardT>
+    void evaluateRows(const typename BoardT::Row* rows, int count, int, BatchFeatures& out, BatchKernel, std::false_type)
+    {
+        evaluateScalar<BoardT>(rows, count, out);
+    }
+}
+
+BatchKernel detectBatchKernel()
+{
+#ifdef BOARDBATCH_X86
+    static const BatchKernel kernel = __builtin_cpu_supports("avx2") ? BatchKernel::Avx2
+                                    : (__builtin_cpu_supports("ssse3") ? BatchKernel::Ssse3 : BatchKernel::Scalar);
+    return kernel;
+#else
+    return BatchKernel::Scalar;
+#endif
+}
+
+bool parseBatchKernel(const char* name, BatchKernel& kernel)
+{
+    if (std::strcmp(name, "scalar") == 0)
+    {
+        kernel = BatchKernel::Scalar;
+    }
+    else if (std::strcmp(name, "ssse3") == 0)
+    {
+        kernel = BatchKernel::Ssse3;
+    }
+    else if (std::strcmp(name, "avx2") == 0)
+    {
+        kernel = BatchKernel::Avx2;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+const char* batchKernelName(BatchKernel kernel)
+{
+    switch (kernel)
+    {
+        case BatchKernel::Avx2:  return "avx2";
+        case BatchKernel::Ssse3: return "ssse3";
+        default:                 return "scalar";
+    }
+}
+
+BoardFeatures BatchFeatures::get(int i) const
+{
+    BoardFeatures features;
+    features.aggregateHeight = aggregateHeight[i];
+    features.holes = holes[i];
+    features.bumpiness = bumpiness[i];
+    features.wells = wells[i];
+    features.rowTransitions = rowTransitions[i];
+    features.lines = lines[i];
+    return features;
+}
+
+template <class BoardT>
+BoardBatch<BoardT>::BoardBatch()
+: count(0),
+  padded(0)
+{}
+
+template <class BoardT>
+void BoardBatch<BoardT>::load(const BoardT& board, int n)
+{
+    count = n < CAPACITY ? n : CAPACITY;
+    padded = (count + LANES - 1) / LANES * LANES;
+    for (int r = 0; r < BoardT::HEIGHT; ++r)
+    {
+        std::fill(rows[r], rows[r] + padded, board.getRowMask(r));
+    }
+}
+
+template <class BoardT>
+void BoardBatch<BoardT>::place(int i, const Tetromino& tetromino)
+{
+    const TetrominoMask& mask = tetromino.getMask();
+    std::pair<int,int> pos = tetromino.getPosition();
+    for (int k = mask.minRow; k <= mask.maxRow; ++k)
+    {
+        rows[pos.first + k][i] |= static_cast<Row>(static_cast<Row>(mask.rows[k]) << (pos.second + mask.minCol));
+    }
+}
+
+template <class BoardT>
+int BoardBatch<BoardT>::size() const
+{
+    return count;
+}
+
+template <class BoardT>
+void BoardBatch<BoardT>::evaluate(BatchFeatures& out, BatchKernel kernel) const
+{
+    BatchKernel best = detectBatchKernel();
+    if (kernel > best)
+    {
+        kernel = best;
+    }
+    evaluateRows<BoardT>(&rows[0][0], count, padded, out, kernel, std::integral_constant<bool, sizeof(Row) == 2>());
+}
+
+template <class BoardT>
+BoardFeatures BoardBatch<BoardT>::countFeatures(const Row* rows, int stride)
+{
+    // 至少 32 位元運算，避免 16 位元的遮罩在取補數時被提升成有號整數
+    typedef typename std::conditional<(sizeof(Row) <= 4), uint32_t, uint64_t>::type Word;
+    const Word full = BoardT::FULL_ROW;
+    const Word leftWall = 1u;
+    const Word rightWall = static_cast<Word>(1) << (BoardT::WIDTH - 1);
+
+    // 由上往下累積 seen：第 c 個位元為 1 表示第 c 欄在這一行或更上面已經有方塊，
+    // 每一行的 popcount 加總起來就是各欄高度、洞、高低差與井深的總和；
+    // 填滿的行直接跳過，結果與先消行再計算相同
+    BoardFeatures features = {0, 0, 0, 0, 0, 0};
+    Word seen = 0;
+
+    for (int r = 0; r < BoardT::HEIGHT; ++r)
+    {
+        Word row = rows[r * stride];
+        if (row == full)
+        {
+            features.lines++;
+            continue;
+        }
+        seen |= row;
+
+        features.aggregateHeight += popcount(seen);
+        features.holes += popcount(seen & ~row);
+        features.bumpiness += popcount((seen ^ (seen >> 1)) & (full >> 1));
+        features.wells += popcount(~seen & full & ((seen << 1) | leftWall) & ((seen >> 1) | rightWall));
+        if (row)
+        {
+            features.rowTransitions += popcount((row ^ (row >> 1)) & (full >> 1)) + popcount(~row & (leftWall | rightWall));
+        }
+    }
+    return features;
+}
+
+#define BOARDBATCH_INSTANTIATE(w, h) template class BoardBatch<BasicBoard<w, h> >;
+BOARD_VARIANTS(BOARDBATCH_INSTANTIATE)
+#undef BOARDBATCH_INSTANTIATE
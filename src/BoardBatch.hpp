@@ -0,0 +1,93 @@
+#ifndef BOARDBATCH
+#define BOARDBATCH
+
+#pragma once
+
+#include <cstdint>
+#include "Board.hpp"
+#include "Tetromino.hpp"
+
+// 批次評估：同一個盤面放上不同落點後的 N 個候選盤面，以 structure-of-arrays 排列
+// (第 r 行的所有候選連續存放)，一次算出全部候選的特徵。
+// 寬度 16 欄以內的棋盤每個候選佔 16-bit，AVX2 一次處理 16 個、SSSE3 一次 8 個；
+// 沒有這些指令集 (或更寬的棋盤) 時以純量迴圈計算，結果完全相同
+
+// 評估核心，可以指定 (基準測試比較用)，平常由 detectBatchKernel() 挑選
+enum class BatchKernel
+{
+    Scalar, Ssse3, Avx2
+};
+
+// 執行期偵測 CPU 支援的最快核心 (只偵測一次)
+BatchKernel detectBatchKernel();
+
+// 命令列用的核心名稱："scalar"、"ssse3"、"avx2"
+bool parseBatchKernel(const char* name, BatchKernel& kernel);
+const char* batchKernelName(BatchKernel kernel);
+
+// 單一盤面的特徵：填滿的行視為已消除 (不必先壓縮盤面)
+struct BoardFeatures
+{
+    int aggregateHeight;   // 各欄高度總和
+    int holes;             // 上方有方塊覆蓋的空格數
+    int bumpiness;         // 相鄰兩欄高度差的總和
+    int wells;             // 比兩側都低的欄位深度總和 (牆壁視為無限高)
+    int rowTransitions;    // 有方塊的行中，相鄰兩格 (含兩側牆壁) 一空一滿的次數
+    int lines;             // 填滿而被消除的行數
+};
+
+// 每個候選盤面的特徵 (意義同 BoardFeatures)，以陣列排列
+struct BatchFeatures
+{
+    static const int CAPACITY = 256;
+
+    uint16_t aggregateHeight[CAPACITY];
+    uint16_t holes[CAPACITY];
+    uint16_t bumpiness[CAPACITY];
+    uint16_t wells[CAPACITY];
+    uint16_t rowTransitions[CAPACITY];
+    uint16_t lines[CAPACITY];
+
+    // 取出第 i 個候選的特徵
+    BoardFeatures get(int i) const;
+};
+
+template <class BoardT>
+class BoardBatch
+{
+    public:
+        typedef typename BoardT::Row Row;
+
+        static const int CAPACITY = BatchFeatures::CAPACITY;
+        static const int LANES = 16;   // 候選數補齊到這個倍數，向量迴圈不必處理尾端
+
+    private:
+        // rows[r][i]：第 i 個候選盤面第 r 行的佔用遮罩
+        Row rows[BoardT::HEIGHT][CAPACITY];
+        int count;
+        int padded;   // count 補齊到 LANES 的倍數，補上的候選與原盤面相同
+
+    public:
+        BoardBatch();
+
+        // 以 board 為所有候選的起點，準備 count 個候選 (最多 CAPACITY 個)
+        void load(const BoardT& board, int count);
+
+        // 把方塊放進第 i 個候選 (方塊位置必須不碰撞；不消行，消行在評估時一併處理)
+        void place(int i, const Tetromino& tetromino);
+
+        int size() const;
+
+        // 算出所有候選的特徵；指定的核心 CPU 不支援時改用支援的最快核心
+        void evaluate(BatchFeatures& out, BatchKernel kernel = detectBatchKernel()) const;
+
+        // 純量計算單一盤面的特徵：rows[r * stride] 為第 r 行 (一般盤面 stride 為 1)
+        static BoardFeatures countFeatures(const Row* rows, int stride);
+};
+
+// 定義在 BoardBatch.cpp，只實體化 BOARD_VARIANTS 列出的尺寸
+#define BOARDBATCH_EXTERN_TEMPLATE(w, h) extern template class BoardBatch<BasicBoard<w, h> >;
+BOARD_VARIANTS(BOARDBATCH_EXTERN_TEMPLATE)
+#undef BOARDBATCH_EXTERN_TEMPLATE
+
+#endif
@@ -0,0 +1,357 @@
+#include "Bot.hpp"
+
+namespace 
+{
+    // 先旋轉與平移再下移：BFS 找到的最短路徑會優先在上方調整，不容易被重力打亂
+    const BotBase::Action SEARCH_ORDER[] = 
+    {
+        BotBase::RotateLeft, BotBase::RotateRight, BotBase::Left, BotBase::Right, BotBase::Down
+    };
+}
+
+BotWeights defaultBotWeights() 
+{
+    BotWeights weights;
+    weights.aggregateHeight = -0.510066;
+    weights.lines = 0.760666;
+    weights.holes = -0.35663;
+    weights.bumpiness = -0.184483;
+    weights.wells = -0.05;
+    weights.rowTransitions = 0.0;
+    return weights;
+}
+
+template <class BoardT>
+BasicBot<BoardT>::BasicBot(const BotWeights& weights)
+: weights(weights),
+  hasTarget(false),
+  pathLength(0),
+  pathStep(0),
+  kernel(detectBatchKernel())
+{}
+
+template <class BoardT>
+int BasicBot<BoardT>::stateIndex(int rotation, int row, int col) 
+{
+    return (rotation * ROWS + row) * COLS + col;
+}
+
+template <class BoardT>
+int BasicBot<BoardT>::stateIndex(const Tetromino& tetromino) 
+{
+    std::pair<int,int> pos = tetromino.getPosition();
+    int col = pos.second + COL_OFFSET;
+    if (pos.first < 0 || pos.first >= BoardT::HEIGHT || col < 0 || col >= COLS) 
+    {
+        return -1;
+    }
+    return stateIndex(tetromino.getRotation(), pos.first, col);
+}
+
+template <class BoardT>
+int BasicBot<BoardT>::search(const BoardT& board, const Tetromino& start, unsigned short* out, int maxPlacements) 
+{
+    enum { FREE = 1, VISITED = 2 };
+
+    // 先一次算出四個旋轉狀態在每一欄的可用 row，走訪時碰撞檢查只剩查表；
+    // 棋盤外的欄與最後一行都不可用，所以走訪時不必再檢查邊界
+    Tetromino rotated = start;
+    for (int i = 0; i < 4; ++i) 
+    {
+        const TetrominoMask& mask = rotated.getMask();
+        unsigned char* plane = cells + rotated.getRotation() * ROWS * COLS;
+
+        for (int col = 0; col < COLS; ++col) 
+        {
+            typename BoardT::RowSet free = board.getFreeRows(mask, col - COL_OFFSET);
+            for (int row = 0; row < ROWS; ++row) 
+            {
+                plane[row * COLS + col] = static_cast<unsigned char>(free >> row & 1u);
+            }
+        }
+        rotated.rotateRight();
+    }
+
+    int startIndex = stateIndex(start);
+    if (startIndex < 0 || !(cells[startIndex] & FREE)) 
+    {
+        return 0;
+    }
+
+    // 每個步驟對狀態編號的位移；旋轉在第 0 與第 3 個平面之間繞回
+    const int PLANE = ROWS * COLS;
+    const int delta[][5] = 
+    {
+        { 3 * PLANE, PLANE, -1, 1, COLS },
+        { -PLANE, PLANE, -1, 1, COLS },
+        { -PLANE, PLANE, -1, 1, COLS },
+        { -PLANE, -3 * PLANE, -1, 1, COLS },
+    };
+
+    cells[startIndex] |= VISITED;
+    queue[0] = static_cast<unsigned short>(startIndex);
+    int head = 0;
+    int tail = 1;
+    int count = 0;
+
+    while (head < tail) 
+    {
+        int current = queue[head++];
+        const int* step = delta[current / PLANE];
+
+        // 再往下一格就碰撞：這是一個落點
+        if (!(cells[current + COLS] & FREE) && count < maxPlacements) 
+        {
+            out[count++] = static_cast<unsigned short>(current);
+        }
+
+        for (int i = 0; i < 5; ++i) 
+        {
+            int next = current + step[i];
+            if (cells[next] != FREE) 
+            {
+                continue;
+            }
+
+            cells[next] |= VISITED;
+            parent[next] = static_cast<unsigned short>(current);
+            parentAction[next] = SEARCH_ORDER[i];
+            queue[tail++] = static_cast<unsigned short>(next);
+        }
+    }
+
+    return count;
+}
+
+template <class BoardT>
+Tetromino BasicBot<BoardT>::moveTo(const Tetromino& start, int state) 
+{
+    Tetromino tetromino = start;
+    std::pair<int,int> pos = start.getPosition();
+    int col = state % COLS - COL_OFFSET;
+    int row = state / COLS % ROWS;
+    int rotation = state / (COLS * ROWS);
+
+    while (tetromino.getRotation() != rotation) 
+    {
+        tetromino.rotateRight();
+    }
+    for (int r = pos.first; r < row; ++r) 
+    {
+        tetromino.moveDown();
+    }
+    for (int c = pos.second; c < col; ++c) 
+    {
+        tetromino.moveRight();
+    }
+    for (int c = pos.second; c > col; --c) 
+    {
+        tetromino.moveLeft();
+    }
+    return tetromino;
+}
+
+template <class BoardT>
+void BasicBot<BoardT>::buildPath(int start, int goal) 
+{
+    pathLength = 0;
+    pathStep = 0;
+
+    for (int index = goal; index != start; index = parent[index]) 
+    {
+        pathLength++;
+    }
+    if (pathLength > MAX_PATH) 
+    {
+        // 實際上不會發生；真的發生就不操作，讓重力把方塊放下
+        pathLength = 0;
+        return;
+    }
+
+    int i = pathLength - 1;
+    for (int index = goal; index != start; index = parent[index], --i) 
+    {
+        pathState[i] = parent[index];
+        pathAction[i] = parentAction[index];
+    }
+
+    // 最後一段只剩往下的步驟時，落點就是 Board::getDropRow()，一次硬降取代
+    int downs = 0;
+    while (pathLength > 0 && pathAction[pathLength - 1] == Down) 
+    {
+        pathLength--;
+        downs++;
+    }
+    if (downs > 0) 
+    {
+        pathAction[pathLength++] = HardDrop;
+    }
+}
+
+template <class BoardT>
+int BasicBot<BoardT>::findPlacements(const BoardT& board, const Tetromino& tetromino, Placement* out, int maxPlacements) 
+{
+    unsigned short states[MAX_PLACEMENTS];
+    int count = search(board, tetromino, states, maxPlacements < MAX_PLACEMENTS ? maxPlacements : MAX_PLACEMENTS);
+
+    for (int i = 0; i < count; ++i) 
+    {
+        out[i].tetromino = moveTo(tetromino, states[i]);
+        out[i].lines = 0;
+        out[i].score = 0.0;
+    }
+    return count;
+}
+
+template <class BoardT>
+void BasicBot<BoardT>::evaluate(const BoardT& board, Placement& placement) const 
+{
+    Row rows[BoardT::HEIGHT];
+    for (int r = 0; r < BoardT::HEIGHT; ++r) 
+    {
+        rows[r] = board.getRowMask(r);
+    }
+
+    // 只在遮罩上放下方塊，不必複製顏色平面；填滿的行在計算特徵時直接跳過
+    const TetrominoMask& mask = placement.tetromino.getMask();
+    std::pair<int,int> pos = placement.tetromino.getPosition();
+    for (int i = mask.minRow; i <= mask.maxRow; ++i) 
+    {
+        rows[pos.first + i] |= static_cast<Row>(static_cast<Row>(mask.rows[i]) << (pos.second + mask.minCol));
+    }
+
+    BoardFeatures features = BoardBatch<BoardT>::countFeatures(rows, 1);
+    placement.lines = features.lines;
+    placement.score = weigh(features, weights);
+}
+
+template <class BoardT>
+double BasicBot<BoardT>::scoreBoard(const BoardT& board, int lines, const BotWeights& weights) 
+{
+    Row rows[BoardT::HEIGHT];
+    for (int r = 0; r < BoardT::HEIGHT; ++r) 
+    {
+        rows[r] = board.getRowMask(r);
+    }
+    BoardFeatures features = BoardBatch<BoardT>::countFeatures(rows, 1);
+    features.lines = lines;
+    return weigh(features, weights);
+}
+
+template <class BoardT>
+double BasicBot<BoardT>::weigh(const BoardFeatures& features, const BotWeights& weights) 
+{
+    return weights.aggregateHeight * features.aggregateHeight
+         + weights.lines * features.lines
+         + weights.holes * features.holes
+         + weights.bumpiness * features.bumpiness
+         + weights.wells * features.wells
+         + weights.rowTransitions * features.rowTransitions;
+}
+
+template <class BoardT>
+bool BasicBot<BoardT>::choose(const BoardT& board, const Tetromino& tetromino) 
+{
+    unsigned short states[MAX_PLACEMENTS];
+    int count = search(board, tetromino, states, MAX_PLACEMENTS);
+
+    // 所有落點一起放進 SoA 候選盤面，以向量核心一次算出特徵
+    batch.load(board, count);
+    for (int i = 0; i < count; ++i) 
+    {
+        batch.place(i, moveTo(tetromino, states[i]));
+    }
+    batch.evaluate(features, kernel);
+
+    int best = -1;
+    double bestScore = 0.0;
+    for (int i = 0; i < count; ++i) 
+    {
+        double score = weigh(features.get(i), weights);
+        if (best < 0 || score > bestScore) 
+        {
+            bestScore = score;
+            best = i;
+        }
+    }
+
+    hasTarget = best >= 0;
+    if (hasTarget) 
+    {
+        target.tetromino = moveTo(tetromino, states[best]);
+        target.lines = features.lines[best];
+        target.score = bestScore;
+        buildPath(stateIndex(tetromino), states[best]);
+    }
+    return hasTarget;
+}
+
+template <class BoardT>
+InputState BasicBot<BoardT>::nextInput(const BoardT& board, const Tetromino& tetromino) 
+{
+    InputState input = {};
+    int current = stateIndex(tetromino);
+
+    // 新方塊，或重力讓方塊離開了規劃的路徑：從目前位置重新挑選
+    bool offPath = pathStep < pathLength && pathState[pathStep] != current;
+    if ((!hasTarget || offPath) && !choose(board, tetromino)) 
+    {
+        return input;
+    }
+
+    // 已經到達落點：不再操作，等重力把方塊固定
+    if (pathStep >= pathLength) 
+    {
+        return input;
+    }
+
+    switch (pathAction[pathStep++]) 
+    {
+        case Left:        input.moveLeft = true;    break;
+        case Right:       input.moveRight = true;   break;
+        case RotateLeft:  input.rotateLeft = true;  break;
+        case RotateRight: input.rotateRight = true; break;
+        case Down:        input.moveDown = true;    break;
+        case HardDrop:    input.hardDrop = true;    break;
+        default: break;
+    }
+
+    return input;
+}
+
+template <class BoardT>
+void BasicBot<BoardT>::reset() 
+{
+    hasTarget = false;
+    pathLength = 0;
+    pathStep = 0;
+}
+
+template <class BoardT>
+void BasicBot<BoardT>::setWeights(const BotWeights& w) 
+{
+    weights = w;
+    reset();
+}
+
+template <class BoardT>
+const BotWeights& BasicBot<BoardT>::getWeights() const 
+{
+    return weights;
+}
+
+template <class BoardT>
+void BasicBot<BoardT>::setBatchKernel(BatchKernel k) 
+{
+    kernel = k;
+}
+
+template <class BoardT>
+BatchKernel BasicBot<BoardT>::getBatchKernel() const 
+{
+    return kernel;
+}
+
+#define BOT_INSTANTIATE(w, h) template class BasicBot<BasicBoard<w, h> >;
+BOARD_VARIANTS(BOT_INSTANTIATE)
+#undef BOT_INSTANTIATE
@@ -0,0 +1,141 @@
+#ifndef BOT
+#define BOT
+
+#pragma once
+
+#include <cstdint>
+#include "Board.hpp"
+#include "BoardBatch.hpp"
+#include "Tetromino.hpp"
+#include "Simulator.hpp"
+
+// 盤面評估的特徵權重 (分數越高越好，所以懲罰項為負值)
+struct BotWeights 
+{
+    double aggregateHeight;  // 各欄高度總和
+    double lines;            // 這一手消除的行數
+    double holes;            // 上方有方塊覆蓋的空格數
+    double bumpiness;        // 相鄰兩欄高度差的總和
+    double wells;            // 比兩側都低的欄位深度總和 (牆壁視為無限高)
+    double rowTransitions;   // 有方塊的行中相鄰兩格一空一滿的次數 (預設 0，供自我對局調整)
+};
+
+// 預設權重
+BotWeights defaultBotWeights();
+
+// 一個可到達的最終落點：方塊在這個狀態再往下一格就會碰撞
+struct Placement 
+{
+    Tetromino tetromino;  // 落點的位置與旋轉狀態
+    int lines;            // 放下後消除的行數
+    double score;         // 評估分數
+};
+
+// 與棋盤尺寸無關的常數與步驟定義
+class BotBase 
+{
+    public:
+        static const int COL_OFFSET = 4;
+        static const int MAX_PLACEMENTS = 256;
+        static const int MAX_PATH = 256;
+
+        // 單一步驟，與 InputState 的欄位一一對應 (HardDrop 只出現在路徑的最後一步)
+        enum Action : unsigned char 
+        {
+            None, Left, Right, RotateLeft, RotateRight, Down, HardDrop
+        };
+};
+
+// 自動遊玩機器人：
+// 以 BFS 走訪 (位置 x 旋轉) 找出目前方塊所有可到達的落點，
+// 用特徵評估挑出最好的一個，再像玩家一樣每個 tick 送出一個輸入。
+// 以棋盤型別為模板參數，狀態空間與評估用的逐行遮罩都隨尺寸在編譯期決定
+template <class BoardT>
+class BasicBot : public BotBase 
+{
+    public:
+        typedef typename BoardT::Row Row;
+
+        // BFS 狀態空間：row 0~HEIGHT (最後一行當作底部的牆)，col -COL_OFFSET~WIDTH+3 (兩側留白當作牆)，4 種旋轉
+        static const int COLS = BoardT::WIDTH + 8;
+        static const int ROWS = BoardT::HEIGHT + 1;
+        static const int STATES = 4 * ROWS * COLS;
+
+        static_assert(STATES <= 65536, "狀態編號以 unsigned short 儲存");
+        static_assert(MAX_PLACEMENTS <= BatchFeatures::CAPACITY, "所有落點要放得進同一批候選盤面");
+
+    private:
+        BotWeights weights;
+
+        // 目前方塊選定的落點，以及從選定時的位置走過去的步驟
+        bool hasTarget;
+        Placement target;
+        unsigned short pathState[MAX_PATH];   // 第 i 步之前方塊應在的狀態
+        unsigned char pathAction[MAX_PATH];   // 第 i 步要送出的輸入
+        int pathLength;
+        int pathStep;
+
+        // BFS 的工作空間 (固定大小，走訪時不配置記憶體)
+        unsigned char cells[STATES];          // 位元 0：此狀態不碰撞；位元 1：本輪已走訪
+        unsigned short queue[STATES];
+        unsigned short parent[STATES];
+        unsigned char parentAction[STATES];
+
+        // 所有落點一起評估的候選盤面與特徵
+        BoardBatch<BoardT> batch;
+        BatchFeatures features;
+        BatchKernel kernel;
+
+        static int stateIndex(int rotation, int row, int col);
+        static int stateIndex(const Tetromino& tetromino);
+
+        // 從 start 開始 BFS，把所有落點的狀態寫入 out，回傳數量
+        int search(const BoardT& board, const Tetromino& start, unsigned short* out, int maxPlacements);
+
+        // 把 start 移動到 state 所代表的位置與旋轉
+        static Tetromino moveTo(const Tetromino& start, int state);
+
+        // 由最近一次 BFS 的父節點還原走到 goal 的步驟
+        void buildPath(int start, int goal);
+
+        // 依特徵計算分數
+        static double weigh(const BoardFeatures& features, const BotWeights& weights);
+
+    public:
+        explicit BasicBot(const BotWeights& weights = defaultBotWeights());
+
+        // 列出所有可到達的最終落點，回傳數量
+        int findPlacements(const BoardT& board, const Tetromino& tetromino, Placement* out, int maxPlacements);
+
+        // 評估把方塊放在 placement 之後的盤面，同時填入 placement 的 lines 與 score
+        void evaluate(const BoardT& board, Placement& placement) const;
+
+        // 依盤面計算特徵分數 (lines 為這一手消除的行數)
+        static double scoreBoard(const BoardT& board, int lines, const BotWeights& weights);
+
+        // 挑出目前方塊的最佳落點並規劃路徑 (所有落點放進 BoardBatch 一次評估)，沒有任何落點時回傳 false
+        bool choose(const BoardT& board, const Tetromino& tetromino);
+
+        // 每個 tick 呼叫：回傳朝目標落點前進的下一個輸入 (一次一步)
+        InputState nextInput(const BoardT& board, const Tetromino& tetromino);
+
+        // 方塊固定後呼叫，下一次 nextInput() 會為新方塊重新挑選落點
+        void reset();
+
+        void setWeights(const BotWeights& weights);
+        const BotWeights& getWeights() const;
+
+        // 批次評估使用的核心 (預設為 CPU 支援的最快核心)，各核心的結果完全相同
+        void setBatchKernel(BatchKernel kernel);
+        BatchKernel getBatchKernel() const;
+};
+
+// 遊戲本體使用標準棋盤
+typedef BasicBot<Board> Bot;
+
+// 定義在 Bot.cpp，只實體化 BOARD_VARIANTS 列出的尺寸
+#define BOT_EXTERN_TEMPLATE(w, h) extern template class BasicBot<BasicBoard<w, h> >;
+BOARD_VARIANTS(BOT_EXTERN_TEMPLATE)
+#undef BOT_EXTERN_TEMPLATE
+
+#endif
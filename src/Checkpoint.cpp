@@ -0,0 +1,159 @@
+#include "Checkpoint.hpp"
+#include "FileFormat.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char CHECKPOINT_MAGIC[4] = { 'O', 'B', 'C', 'K' };
+}
+
+Checkpoint::Checkpoint()
+: file(nullptr),
+  generation(0),
+  nextSlot(0)
+{}
+
+Checkpoint::~Checkpoint()
+{
+    close();
+}
+
+uint64_t Checkpoint::checksum(const CheckpointSlot& slot)
+{
+    uint64_t hash = fnv(FNV_OFFSET, &slot.generation, sizeof(slot.generation));
+    return fnv(hash, &slot.state, sizeof(slot.state));
+}
+
+bool Checkpoint::isValid(int slot) const
+{
+    const CheckpointSlot& s = file->slots[slot];
+    return s.generation != 0 && s.checksum == checksum(s);
+}
+
+bool Checkpoint::open(const std::string& path, std::string& error)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1)
+    {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == -1)
+    {
+        error = path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    // 大小不符 (新檔案或其他版本) 時清空重建
+    bool fresh = static_cast<size_t>(info.st_size) != sizeof(CheckpointFile);
+    if (fresh && (ftruncate(fd, 0) == -1 || ftruncate(fd, sizeof(CheckpointFile)) == -1))
+    {
+        error = path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, sizeof(CheckpointFile), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+    file = static_cast<CheckpointFile*>(mapping);
+
+    CheckpointHeader& header = file->header;
+    if (!fresh && (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0
+                   || header.version != CHECKPOINT_VERSION || header.flags != BUILD_FLAGS
+                   || header.stateSize != sizeof(SimulatorState)))
+    {
+        fresh = true;
+    }
+    if (fresh)
+    {
+        std::memset(static_cast<void*>(file), 0, sizeof(CheckpointFile));
+        std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+        header.version = CHECKPOINT_VERSION;
+        header.flags = BUILD_FLAGS;
+        header.stateSize = sizeof(SimulatorState);
+    }
+
+    // 下一次寫進較舊 (或無效) 的槽位
+    generation = 0;
+    nextSlot = 0;
+    for (int i = 0; i < 2; ++i)
+    {
+        if (isValid(i) && file->slots[i].generation > generation)
+        {
+            generation = file->slots[i].generation;
+            nextSlot = 1 - i;
+        }
+    }
+    return true;
+}
+
+void Checkpoint::close()
+{
+    if (file)
+    {
+        munmap(file, sizeof(CheckpointFile));
+        file = nullptr;
+    }
+}
+
+bool Checkpoint::isOpen() const
+{
+    return file != nullptr;
+}
+
+bool Checkpoint::load(SimulatorState& state) const
+{
+    if (!file || generation == 0)
+    {
+        return false;
+    }
+    state = file->slots[1 - nextSlot].state;
+    return true;
+}
+
+void Checkpoint::save(const Simulator& simulator, bool sync)
+{
+    if (!file)
+    {
+        return;
+    }
+
+    CheckpointSlot& slot = file->slots[nextSlot];
+    slot.generation = ++generation;
+    simulator.saveState(slot.state);
+    slot.checksum = checksum(slot);
+    nextSlot = 1 - nextSlot;
+
+    if (sync)
+    {
+        msync(file, sizeof(CheckpointFile), MS_SYNC);
+    }
+}
+
+void Checkpoint::clear()
+{
+    if (!file)
+    {
+        return;
+    }
+    file->slots[0].generation = 0;
+    file->slots[1].generation = 0;
+    generation = 0;
+    nextSlot = 0;
+    msync(file, sizeof(CheckpointFile), MS_SYNC);
+}
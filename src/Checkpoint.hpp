@@ -0,0 +1,79 @@
+#ifndef CHECKPOINT
+#define CHECKPOINT
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include "Simulator.hpp"
+
+#define DEFAULT_CHECKPOINT_PATH "./oblivionis.ckpt"
+
+// 存檔 = 16 位元組檔頭 + 兩個槽位，整個檔案以 mmap 對映。
+// 每次存檔寫進較舊的那個槽位 (世代編號 + 狀態 + 檢查碼)，另一個槽位保持完整；
+// 讀取時取檢查碼正確、世代最新的槽位。寫到一半當掉的槽位檢查碼不符，會退回上一份存檔。
+// 存檔只是幾百個位元組的複製，寫回磁碟交給核心 (行程當掉時頁快取仍會寫回)；
+// 關卡之間的倒數才以 msync 同步寫入，不會在遊戲中造成停頓
+
+static const uint16_t CHECKPOINT_VERSION = 1;
+
+static_assert(std::is_trivially_copyable<SimulatorState>::value, "SimulatorState 必須可以直接寫進檔案");
+
+struct CheckpointHeader
+{
+    char magic[4];          // "OBCK"
+    uint16_t version;
+    uint8_t flags;          // BUILD_FLAGS (FileFormat.hpp)
+    uint8_t reserved;
+    uint32_t stateSize;     // sizeof(SimulatorState)，結構改變時舊存檔自動作廢
+    uint32_t reserved2;
+};
+
+struct CheckpointSlot
+{
+    uint64_t generation;    // 0 表示空的槽位
+    uint64_t checksum;      // 世代與狀態的 FNV-1a
+    SimulatorState state;
+};
+
+struct CheckpointFile
+{
+    CheckpointHeader header;
+    CheckpointSlot slots[2];
+};
+
+class Checkpoint
+{
+    private:
+        CheckpointFile* file;
+        uint64_t generation;    // 最新一份存檔的世代
+        int nextSlot;           // 下一次要寫入的槽位 (較舊的那個)
+
+        static uint64_t checksum(const CheckpointSlot& slot);
+        bool isValid(int slot) const;
+
+    public:
+        Checkpoint();
+        ~Checkpoint();
+
+        Checkpoint(const Checkpoint&) = delete;
+        Checkpoint& operator=(const Checkpoint&) = delete;
+
+        // 開啟或建立存檔 (格式不符的舊檔案會被清空)
+        bool open(const std::string& path, std::string& error);
+        void close();
+
+        bool isOpen() const;
+
+        // 取出最新且完整的存檔，沒有時回傳 false
+        bool load(SimulatorState& state) const;
+
+        // 寫入一份新的存檔；sync 為 true 時等待寫回磁碟 (只在關卡之間使用)
+        void save(const Simulator& simulator, bool sync);
+
+        // 遊戲結束：作廢所有存檔
+        void clear();
+};
+
+#endif
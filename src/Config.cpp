@@ -0,0 +1,298 @@
+#include "Config.hpp"
+#include "Renderer.hpp"
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>        // for read(), close()
+#include <sys/inotify.h>
+
+// 鍵名 -> 動作，順序與 InputAction 相同
+static const char* KEY_NAMES[] =
+{
+    "KEY_LEFT",
+    "KEY_RIGHT",
+    "KEY_DOWN",
+    "KEY_ROTATE_LEFT",
+    "KEY_ROTATE_RIGHT",
+    "KEY_HARD_DROP",
+    "KEY_QUIT",
+};
+
+static const char* SOUND_NAMES[] =
+{
+    "SOUND_ROTATE",
+    "SOUND_LINE_CLEAR",
+};
+
+Config::Config()
+: soundCooldownMs(500),
+  dasMs(KeyRepeater::DEFAULT_DAS_MS),
+  arrMs(KeyRepeater::DEFAULT_ARR_MS),
+  releaseMs(KeyRepeater::DEFAULT_RELEASE_MS),
+  renderFps(60),
+  boardOffset(Renderer::DEFAULT_BOARD_OFFSET)
+{
+    for (int i = 0; i < Simulator::MAX_LEVEL; ++i)
+    {
+        levelTrack[i] = NO_TRACK;
+        gravityMs[i] = Simulator::DEFAULT_GRAVITY_MS[i];
+        levelThresholds[i] = Simulator::DEFAULT_LEVEL_THRESHOLDS[i];
+    }
+    InputHandler::defaultKeymap(keymap);
+}
+
+static std::string trim(const std::string& text)
+{
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+    {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+// 解析 [minValue, maxValue] 範圍內的整數
+static bool parseInt(const std::string& text, int minValue, int maxValue, int& out)
+{
+    if (text.empty())
+    {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    long value = std::strtol(text.c_str(), &end, 10);
+    if (errno != 0 || *end != '\0' || value < minValue || value > maxValue)
+    {
+        return false;
+    }
+    out = static_cast<int>(value);
+    return true;
+}
+
+// 解析以逗號分隔、每一關一個值的曲線
+static bool parseCurve(const std::string& text, int (&out)[Simulator::MAX_LEVEL])
+{
+    int values[Simulator::MAX_LEVEL];
+    size_t start = 0;
+    for (int i = 0; i < Simulator::MAX_LEVEL; ++i)
+    {
+        size_t comma = text.find(',', start);
+        bool last = i == Simulator::MAX_LEVEL - 1;
+        if ((comma == std::string::npos) != last)
+        {
+            return false;
+        }
+        std::string item = trim(text.substr(start, last ? std::string::npos : comma - start));
+        if (!parseInt(item, 1, 1000000000, values[i]))
+        {
+            return false;
+        }
+        start = comma + 1;
+    }
+    std::memcpy(out, values, sizeof(values));
+    return true;
+}
+
+static int findTrack(std::vector<std::string>& tracks, const std::string& path)
+{
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        if (tracks[i] == path)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    tracks.push_back(path);
+    return static_cast<int>(tracks.size()) - 1;
+}
+
+static bool applySetting(Config& config, const std::string& key, const std::string& value)
+{
+    if (key.compare(0, 4, "BGM_") == 0)
+    {
+        int level = 0;
+        if (!parseInt(key.substr(4), 1, Simulator::MAX_LEVEL, level) || value.empty())
+        {
+            return false;
+        }
+        config.levelTrack[level - 1] = findTrack(config.tracks, value);
+        return true;
+    }
+
+    for (int i = 0; i < Config::SOUND_EFFECTS; ++i)
+    {
+        if (key == SOUND_NAMES[i])
+        {
+            config.soundPaths[i] = value;
+            return true;
+        }
+    }
+
+    for (int i = 0; i < KeyRepeater::ACTIONS; ++i)
+    {
+        if (key != KEY_NAMES[i])
+        {
+            continue;
+        }
+        // 空白在行尾會被去掉，以 SPACE 表示
+        const std::string keys = value == "SPACE" ? " " : value;
+        for (char c : keys)
+        {
+            if (static_cast<unsigned char>(c) >= Config::KEYMAP_SIZE || c == '\x1B')
+            {
+                return false;
+            }
+        }
+        // 取代這個動作原本的按鍵
+        for (int c = 0; c < Config::KEYMAP_SIZE; ++c)
+        {
+            if (config.keymap[c] == i)
+            {
+                config.keymap[c] = -1;
+            }
+        }
+        for (char c : keys)
+        {
+            config.keymap[static_cast<unsigned char>(c)] = static_cast<int8_t>(i);
+        }
+        return true;
+    }
+
+    if (key == "GRAVITY_MS")
+    {
+        return parseCurve(value, config.gravityMs);
+    }
+    if (key == "LEVEL_THRESHOLDS")
+    {
+        return parseCurve(value, config.levelThresholds);
+    }
+    if (key == "DAS_MS")
+    {
+        return parseInt(value, 0, 2000, config.dasMs);
+    }
+    if (key == "ARR_MS")
+    {
+        return parseInt(value, 1, 1000, config.arrMs);
+    }
+    if (key == "RELEASE_MS")
+    {
+        return parseInt(value, 10, 2000, config.releaseMs);
+    }
+    if (key == "SOUND_COOLDOWN_MS")
+    {
+        return parseInt(value, 0, 10000, config.soundCooldownMs);
+    }
+    if (key == "RENDER_FPS")
+    {
+        return parseInt(value, 1, 240, config.renderFps);
+    }
+    if (key == "RENDER_OFFSET")
+    {
+        return parseInt(value, 0, 40, config.boardOffset);
+    }
+    return false;
+}
+
+bool loadConfig(const std::string& path, Config& config, std::string& warnings)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        warnings = "無法讀取 " + path;
+        return false;
+    }
+
+    Config parsed;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        line = trim(line);
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        size_t delimiterPos = line.find('=');
+        std::string key = trim(line.substr(0, delimiterPos));
+        std::string value = delimiterPos == std::string::npos ? "" : trim(line.substr(delimiterPos + 1));
+        if (delimiterPos == std::string::npos || !applySetting(parsed, key, value))
+        {
+            warnings += path + ":" + std::to_string(lineNumber) + ": 無效的設定 " + line + "\n";
+        }
+    }
+
+    config = parsed;
+    return true;
+}
+
+ConfigWatcher::ConfigWatcher()
+: fd(-1)
+{}
+
+ConfigWatcher::~ConfigWatcher()
+{
+    stop();
+}
+
+bool ConfigWatcher::watch(const std::string& path)
+{
+    stop();
+
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd == -1)
+    {
+        return false;
+    }
+    if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1)
+    {
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void ConfigWatcher::stop()
+{
+    if (fd != -1)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool ConfigWatcher::changed()
+{
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    bool touched = false;
+    alignas(struct inotify_event) char buffer[4096];
+    while (true)
+    {
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n <= 0)
+        {
+            break;
+        }
+        for (ssize_t offset = 0; offset < n; )
+        {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            if (event->len > 0 && name == event->name)
+            {
+                touched = true;
+            }
+            offset += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return touched;
+}
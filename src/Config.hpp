@@ -0,0 +1,78 @@
+#ifndef CONFIG
+#define CONFIG
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Simulator.hpp"
+#include "InputHandler.hpp"
+
+#define DEFAULT_CONFIG_PATH "./src/config.txt"
+
+// 音效編號 (取代原本的字串鍵)
+enum class SoundEffect
+{
+    Rotate, LineClear, Count
+};
+
+// 解析後的設定：檔名與字串只存在這裡，遊戲中只用整數編號查表
+struct Config
+{
+    static const int SOUND_EFFECTS = static_cast<int>(SoundEffect::Count);
+    static const int KEYMAP_SIZE = InputHandler::KEYMAP_SIZE;
+    static const int NO_TRACK = -1;
+
+    // BGM：不重複的檔名表，每一關存的是表中的編號 (沒有設定為 NO_TRACK)
+    std::vector<std::string> tracks;
+    int levelTrack[Simulator::MAX_LEVEL];
+
+    // 音效檔與同一音效的最短間隔
+    std::string soundPaths[SOUND_EFFECTS];
+    int soundCooldownMs;
+
+    // 鍵盤：字元 -> InputAction 編號 (-1 表示不處理)；方向鍵與 ESC 固定
+    int8_t keymap[KEYMAP_SIZE];
+    int dasMs;
+    int arrMs;
+    int releaseMs;
+
+    // 難度曲線：沒有設定時為 Simulator 內建的曲線
+    int gravityMs[Simulator::MAX_LEVEL];
+    int levelThresholds[Simulator::MAX_LEVEL];
+
+    // 畫面
+    int renderFps;      // 繪製頻率上限
+    int boardOffset;    // 盤面的水平縮排
+
+    // 預設值 (與沒有設定檔時的行為相同)
+    Config();
+};
+
+// 解析 KEY=VALUE 格式的設定檔 (# 開頭為註解)。
+// 檔案無法讀取時回傳 false；個別錯誤的設定沿用預設值並寫進 warnings
+bool loadConfig(const std::string& path, Config& config, std::string& warnings);
+
+// 以 inotify 監看設定檔：監看所在的目錄，編輯器以「寫到暫存檔再改名」的方式存檔也收得到
+class ConfigWatcher
+{
+    private:
+        int fd;             // inotify (非阻塞)，-1 表示沒有監看
+        std::string name;   // 設定檔在目錄中的檔名
+
+    public:
+        ConfigWatcher();
+        ~ConfigWatcher();
+
+        ConfigWatcher(const ConfigWatcher&) = delete;
+        ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+        bool watch(const std::string& path);
+        void stop();
+
+        // 讀完所有待處理的通知，設定檔有被寫入或取代時回傳 true (不阻塞)
+        bool changed();
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef FILE_FORMAT
+#define FILE_FORMAT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 重播檔、存檔、成績記錄與對戰握手共用的檔頭旗標與 FNV-1a 雜湊
+
+static const uint8_t BUILD_FLAG_TEST_MODE = 0x1;   // 以 -DTEST_MODE 建置 (關卡門檻與重力不同，不能與一般建置混用)
+
+#ifdef TEST_MODE
+static const uint8_t BUILD_FLAGS = BUILD_FLAG_TEST_MODE;
+#else
+static const uint8_t BUILD_FLAGS = 0;
+#endif
+
+static const uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+static const uint64_t FNV_PRIME = 0x100000001B3ull;
+
+// 依序雜湊 data 的 size 個位元組
+inline uint64_t fnv(uint64_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+// 由低到高雜湊 value 的 bytes 個位元組 (與平台的位元組順序無關)
+inline uint64_t fnvValue(uint64_t hash, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        hash = (hash ^ ((value >> (8 * i)) & 0xFF)) * FNV_PRIME;
+    }
+    return hash;
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include "FrameTimer.hpp"
+#include <cstring>
+#include <cmath>
+
+static const char* PHASE_NAMES[] =
+{
+    "input",
+    "update",
+    "render",
+    "idle",
+    "draw",
+};
+
+const char* framePhaseName(FramePhase phase)
+{
+    return PHASE_NAMES[static_cast<int>(phase)];
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::reset()
+{
+    std::memset(counts, 0, sizeof(counts));
+    total = 0;
+    sum = 0;
+    maxValue = 0;
+}
+
+uint64_t LatencyHistogram::bucketLower(int index)
+{
+    if (index < SUB_COUNT)
+    {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = (index >> SUB_BITS) - 1;
+    return static_cast<uint64_t>(SUB_COUNT + (index & (SUB_COUNT - 1))) << shift;
+}
+
+uint64_t LatencyHistogram::bucketUpper(int index)
+{
+    if (index < SUB_COUNT)
+    {
+        return static_cast<uint64_t>(index) + 1;
+    }
+    int shift = (index >> SUB_BITS) - 1;
+    return bucketLower(index) + (1ull << shift);
+}
+
+uint64_t LatencyHistogram::percentile(double q) const
+{
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    uint64_t target = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    if (target < 1)
+    {
+        target = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i)
+    {
+        seen += counts[i];
+        if (seen >= target)
+        {
+            uint64_t upper = bucketUpper(i) - 1;
+            return upper < maxValue ? upper : maxValue;
+        }
+    }
+    return maxValue;
+}
+
+PhaseTiming LatencyHistogram::summary() const
+{
+    PhaseTiming timing;
+    timing.p50 = percentile(0.50);
+    timing.p99 = percentile(0.99);
+    timing.max = maxValue;
+    return timing;
+}
+
+void FrameTimer::summarize(FrameTimingSummary& out) const
+{
+    for (int i = 0; i < static_cast<int>(FramePhase::Count); ++i)
+    {
+        out.phases[i] = histograms[i].summary();
+    }
+}
+
+void FrameTimer::dump(std::FILE* file) const
+{
+    std::fprintf(file, "# frame phase timings (ns)\n");
+    std::fprintf(file, "phase\tcount\tmean\tp50\tp90\tp99\tp99.9\tmax\n");
+    for (int i = 0; i < static_cast<int>(FramePhase::Count); ++i)
+    {
+        const LatencyHistogram& h = histograms[i];
+        std::fprintf(file, "%s\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu\n",
+                     PHASE_NAMES[i],
+                     static_cast<unsigned long long>(h.count()),
+                     static_cast<unsigned long long>(h.mean()),
+                     static_cast<unsigned long long>(h.percentile(0.50)),
+                     static_cast<unsigned long long>(h.percentile(0.90)),
+                     static_cast<unsigned long long>(h.percentile(0.99)),
+                     static_cast<unsigned long long>(h.percentile(0.999)),
+                     static_cast<unsigned long long>(h.max()));
+    }
+
+    // 完整分布：只列出非空的桶，可以直接畫成直方圖
+    std::fprintf(file, "\n# histogram\nphase\tlower\tupper\tcount\n");
+    for (int i = 0; i < static_cast<int>(FramePhase::Count); ++i)
+    {
+        const LatencyHistogram& h = histograms[i];
+        for (int b = 0; b < LatencyHistogram::BUCKETS; ++b)
+        {
+            if (h.bucketCount(b) == 0)
+            {
+                continue;
+            }
+            std::fprintf(file, "%s\t%llu\t%llu\t%u\n",
+                         PHASE_NAMES[i],
+                         static_cast<unsigned long long>(LatencyHistogram::bucketLower(b)),
+                         static_cast<unsigned long long>(LatencyHistogram::bucketUpper(b)),
+                         h.bucketCount(b));
+        }
+    }
+}
+
+bool FrameTimer::dump(const char* path) const
+{
+    std::FILE* file = std::fopen(path, "w");
+    if (!file)
+    {
+        return false;
+    }
+    dump(file);
+    return std::fclose(file) == 0;
+}
@@ -0,0 +1,124 @@
+#ifndef FRAMETIMER
+#define FRAMETIMER
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+// 主迴圈每一幀的階段 (Draw 在繪製執行緒，其餘在遊戲執行緒)
+enum class FramePhase
+{
+    HandleEvents,   // 讀取終端機輸入並解析
+    Update,         // 推進 tick (包含消行、音效呼叫)
+    Render,         // 填快照並發佈給繪製執行緒
+    Idle,           // 等待輸入或下一個 tick
+    Draw,           // Renderer::draw (組畫面 + write 到終端機)
+    Count
+};
+
+const char* framePhaseName(FramePhase phase);
+
+// 單一階段給畫面顯示用的摘要 (奈秒)
+struct PhaseTiming
+{
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t max;
+};
+
+// 所有階段的摘要，放在 FrameSnapshot 裡交給繪製執行緒
+struct FrameTimingSummary
+{
+    PhaseTiming phases[static_cast<int>(FramePhase::Count)];
+};
+
+// HDR 風格的延遲直方圖：每個 2 的次方區間再切成 2^SUB_BITS 個等寬的子桶，
+// 相對誤差不超過 1/32；記錄一筆只是一次 clz 加一次陣列遞增，不配置記憶體
+class LatencyHistogram
+{
+    public:
+        static const int SUB_BITS = 5;
+        static const int SUB_COUNT = 1 << SUB_BITS;
+        static const int MAX_EXPONENT = 39;   // 2^40 ns (約 18 分鐘) 以上都算進最後一個桶
+        static const int BUCKETS = (MAX_EXPONENT - SUB_BITS + 2) << SUB_BITS;
+
+    private:
+        uint32_t counts[BUCKETS];
+        uint64_t total;
+        uint64_t sum;
+        uint64_t maxValue;
+
+        static int bucketIndex(uint64_t value)
+        {
+            if (value < static_cast<uint64_t>(SUB_COUNT))
+            {
+                return static_cast<int>(value);
+            }
+            int exponent = 63 - __builtin_clzll(value);
+            if (exponent > MAX_EXPONENT)
+            {
+                return BUCKETS - 1;
+            }
+            int shift = exponent - SUB_BITS;
+            return ((shift + 1) << SUB_BITS) + static_cast<int>((value >> shift) & (SUB_COUNT - 1));
+        }
+
+    public:
+        LatencyHistogram();
+
+        void reset();
+
+        void record(uint64_t value)
+        {
+            counts[bucketIndex(value)]++;
+            total++;
+            sum += value;
+            if (value > maxValue)
+            {
+                maxValue = value;
+            }
+        }
+
+        // 桶的範圍 [lower, upper)
+        static uint64_t bucketLower(int index);
+        static uint64_t bucketUpper(int index);
+
+        // 第 q 百分位 (0~1)，回傳所在桶的上界，不超過實際最大值
+        uint64_t percentile(double q) const;
+
+        uint64_t count() const { return total; }
+        uint64_t mean() const { return total > 0 ? sum / total : 0; }
+        uint64_t max() const { return maxValue; }
+        uint32_t bucketCount(int index) const { return counts[index]; }
+
+        PhaseTiming summary() const;
+};
+
+// 各階段一個直方圖；只由單一執行緒寫入
+class FrameTimer
+{
+    private:
+        LatencyHistogram histograms[static_cast<int>(FramePhase::Count)];
+
+    public:
+        typedef std::chrono::steady_clock::time_point TimePoint;
+
+        void record(FramePhase phase, TimePoint begin, TimePoint end)
+        {
+            long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+            histograms[static_cast<int>(phase)].record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+        }
+
+        LatencyHistogram& get(FramePhase phase) { return histograms[static_cast<int>(phase)]; }
+        const LatencyHistogram& get(FramePhase phase) const { return histograms[static_cast<int>(phase)]; }
+
+        void summarize(FrameTimingSummary& out) const;
+
+        // 以文字表格寫出每個階段的統計與非空的桶
+        void dump(std::FILE* file) const;
+        bool dump(const char* path) const;
+};
+
+#endif
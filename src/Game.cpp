@@ -4,49 +4,202 @@
 #include <ctime>
 #include <thread>
 #include <chrono>
+#include <random>
 
 // 設定音效播放的最短間隔時間（秒）
 #define SOUND_COOLDOWN 0.3
 
+// 一次喚醒最多補跑的 tick 數，避免長時間停頓後一口氣狂跑
+#define MAX_CATCHUP_TICKS 5
+
+// 遊戲中定期存檔的間隔 (tick 數，1 秒)
+#define CHECKPOINT_INTERVAL_TICKS 100
+
 // 記錄上次播放音效的時間
-std::chrono::steady_clock::time_point lastMoveSoundTime;
 std::chrono::steady_clock::time_point lastRotateSoundTime;
 
-Game::Game(): running(false), frameCount(0), framesPerDrop(30) {}
+Game::Game(const GameOptions& options)
+: running(false),
+  dirty(true),
+  versus(!options.hostPath.empty() || !options.joinPath.empty()),
+  options(options),
+  inputLatencySumUs(0),
+  inputLatencyMaxUs(0),
+  inputLatencyCount(0)
+{}
 
 Game::~Game() {}
 
-void Game::init() 
+bool Game::init() 
 {
+    // 重播模式：種子與方塊產生規則都來自重播檔
+    if (!options.replayPath.empty()) 
+    {
+        std::string error;
+        if (!replayFile.open(options.replayPath, error) 
+            || !replayPlayer.load(replayFile.data(), replayFile.size(), error)) 
+        {
+            std::cerr << "[Replay] " << error << "\n";
+            return false;
+        }
+        options.hasSeed = true;
+        options.seed = replayPlayer.getHeader().seed;
+        options.randomizer = replayPlayer.getRandomizerMode();
+    }
+
+    // 沒有指定種子時隨機挑一個，離開時印出來，之後可以用 --seed 重現同一局
+    if (!options.hasSeed) 
+    {
+        std::random_device device;
+        options.seed = (static_cast<uint64_t>(device()) << 32) ^ device()
+                     ^ static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    }
+
+    // 對戰：連線在終端機切換模式之前完成 (等待時可以 Ctrl-C)
+    if (versus && !connectVersus()) 
+    {
+        return false;
+    }
+
+    if (!options.broadcastName.empty()) 
+    {
+        std::string error;
+        if (!broadcast.open(options.broadcastName, error)) 
+        {
+            std::cerr << "[Broadcast] " << error << "\n";
+            return false;
+        }
+        std::cout << "[Broadcast] 以 --spectate " << options.broadcastName << " 觀戰\n";
+    }
+
     inputHandler.initTerminal();
 
     running = true;
-    board = Board();
-    currentTetromino = Tetromino();
-    renderer = Renderer();
-    scoreManager = ScoreManager();
-    audioManager = AudioManager();
 
-    level = 1;
-    framesPerDrop = 30;
+    simulator = Simulator(options.seed, options.randomizer);
+    opponent = Simulator(options.seed, options.randomizer);
+
+    if (!options.recordPath.empty()) 
+    {
+        recorder.begin(options.seed, options.randomizer);
+    }
+    openCheckpoint();
+    keyRepeater = KeyRepeater();
+    bot.reset();
 
-    audioManager.playMusic(level);
+    // 設定檔在這之後有變更就即時套用
+    if (options.configPath.empty()) 
+    {
+        options.configPath = DEFAULT_CONFIG_PATH;
+    }
+    loadSettings();
+    configWatcher.watch(options.configPath);
 
-    countdownBeforeStart();
+    audioManager.playMusic(simulator.getLevel());
     std::cout << "[Game] Initialized.\n";
+
+    // 之後終端機輸出都交給繪製執行緒
+    renderThread.invalidate();
+    renderThread.start();
+
+    countdownBeforeStart();
+    return true;
+}
+
+bool Game::connectVersus() 
+{
+    if (!options.hostPath.empty() && !options.joinPath.empty()) 
+    {
+        std::cerr << "[Versus] --host 與 --join 只能選一個\n";
+        return false;
+    }
+    if (!options.recordPath.empty() || !options.replayPath.empty()) 
+    {
+        std::cerr << "[Versus] 對戰模式不能錄製或播放重播\n";
+        return false;
+    }
+
+    std::string error;
+    if (!options.hostPath.empty()) 
+    {
+        std::cout << "[Versus] 等待對手連線 " << options.hostPath << " ..." << std::endl;
+        if (!versusLink.host(options.hostPath, options.seed, options.randomizer, error)) 
+        {
+            std::cerr << "[Versus] " << error << "\n";
+            return false;
+        }
+    }
+    else 
+    {
+        if (!versusLink.join(options.joinPath, options.seed, options.randomizer, error)) 
+        {
+            std::cerr << "[Versus] " << error << "\n";
+            return false;
+        }
+        options.hasSeed = true;
+    }
+    std::cout << "[Versus] 已連線\n";
+    return true;
+}
+
+void Game::openCheckpoint() 
+{
+    // 重播與對戰的結果必須由種子與輸入重現，不存檔；機器人只在明確指定 --checkpoint 時存檔，不蓋掉玩家的存檔
+    bool enabled = options.recordPath.empty() && options.replayPath.empty() && !versus
+                   && (!options.bot || !options.checkpointPath.empty());
+    if (!enabled) 
+    {
+        if (options.resume) 
+        {
+            std::cerr << "[Checkpoint] 這個模式不能使用 --resume\n";
+        }
+        return;
+    }
+
+    if (options.checkpointPath.empty()) 
+    {
+        options.checkpointPath = DEFAULT_CHECKPOINT_PATH;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    std::string error;
+    if (!checkpoint.open(options.checkpointPath, error)) 
+    {
+        std::cerr << "[Checkpoint] " << error << "\n";
+        return;
+    }
+
+    if (!options.resume) 
+    {
+        // 不在這裡清掉舊存檔：新的一局第一次存檔的世代較新，自然取代它；
+        // 存檔只在遊戲真正結束時清除 (cleanup)
+        return;
+    }
+
+    SimulatorState state;
+    if (!checkpoint.load(state)) 
+    {
+        std::cout << "[Checkpoint] " << options.checkpointPath << " 沒有可以繼續的存檔，開始新的一局\n";
+        return;
+    }
+    simulator.loadState(state);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "[Checkpoint] 從關卡 " << simulator.getLevel() << "、分數 " << simulator.getScoreManager().getScore()
+              << " 繼續 (" << ms << " ms)\n";
 }
 
 void Game::countdownBeforeStart() 
 {
-    std::cout << "[Level " << level << "] 即將開始...\n";
-    
+    // 倒數訊息顯示在繪製執行緒的狀態列
     for (int i = 3; i > 0; --i) 
     {
-        std::cout << "倒數 " << i << " 秒...\r" << std::flush;
+        render(i);
         std::this_thread::sleep_for(std::chrono::seconds(1));  // 延遲 1 秒
     }
-    
-    std::cout << "開始！        " << std::endl;  // 確保清除上一行
+
+    // 倒數期間不推進遊戲，從現在重新開始計時
+    nextTick = std::chrono::steady_clock::now();
+    dirty = true;
 }
 
 void Game::run() 
@@ -54,9 +207,26 @@ void Game::run()
     // 主迴圈
     while (running) 
     {
-        handleEvents();
+        waitForNextEvent();
+
+        if (configWatcher.changed()) 
+        {
+            // 目前關卡的 BGM 換了就立刻交叉淡化過去
+            loadSettings();
+            audioManager.playMusic(simulator.getLevel());
+        }
+
+        auto updateBegin = std::chrono::steady_clock::now();
         update();
-        render();
+        auto updateEnd = std::chrono::steady_clock::now();
+        frameTimer.record(FramePhase::Update, updateBegin, updateEnd);
+
+        if (dirty) 
+        {
+            render();
+            dirty = false;
+            frameTimer.record(FramePhase::Render, updateEnd, std::chrono::steady_clock::now());
+        }
     }
 
     cleanup();
@@ -64,184 +234,445 @@ void Game::run()
 
 void Game::cleanup() 
 {
+    // 先停下繪製執行緒 (會畫完最後一幀)，之後才能直接輸出訊息
+    renderThread.stop();
     inputHandler.restoreTerminal();
 
+    // 觀眾會畫完最後一幀後離開
+    broadcast.close();
+
+    if (checkpoint.isOpen()) 
+    {
+        // 只有一條命：結束後不能再從存檔繼續；中途離開則保留目前的進度
+        if (simulator.isOver()) 
+        {
+            checkpoint.clear();
+        }
+        else 
+        {
+            checkpoint.save(simulator, true);
+            std::cout << "[Checkpoint] 已存檔，下次以 --resume 繼續\n";
+        }
+        checkpoint.close();
+    }
+
+    if (versus) 
+    {
+        // 先完成所有關卡的一方贏，沒完成就結束的一方輸
+        bool selfLost = simulator.isOver() && simulator.getLevel() <= Simulator::MAX_LEVEL;
+        bool opponentLost = opponent.isOver() && opponent.getLevel() <= Simulator::MAX_LEVEL;
+        bool selfCompleted = simulator.getLevel() > Simulator::MAX_LEVEL;
+        bool opponentCompleted = opponent.getLevel() > Simulator::MAX_LEVEL;
+        if (!versusError.empty()) 
+        {
+            std::cout << "\n[Versus] 對戰中斷：" << versusError << "\n";
+        }
+        else if (!simulator.isOver() && !opponent.isOver()) 
+        {
+            std::cout << "\n[Versus] 你離開了對戰\n";
+        }
+        else if ((opponentLost && !selfLost) || (selfCompleted && !opponentCompleted)) 
+        {
+            std::cout << "\n[Versus] 你贏了！\n";
+        }
+        else if ((selfLost && !opponentLost) || (opponentCompleted && !selfCompleted)) 
+        {
+            std::cout << "\n[Versus] 你輸了\n";
+        }
+        else 
+        {
+            std::cout << "\n[Versus] 平手\n";
+        }
+
+        const LatencyHistogram& waits = versusLink.getWaitTimes();
+        if (waits.count() > 0) 
+        {
+            std::cout << "[Versus] " << waits.count() << " ticks, 等待對手 p50 " << waits.percentile(0.50) / 1000.0
+                      << " us, p99 " << waits.percentile(0.99) / 1000.0 << " us, 最大 " << waits.max() / 1000.0 << " us\n";
+        }
+        versusLink.close();
+    }
+    else if (simulator.getLevel() > Simulator::MAX_LEVEL) 
+    {
+        std::cout << "\n[Game Over] 你已完成所有關卡！感謝遊玩！\n";
+    }
+
+    // 重播只是重現錄製過的一局，不重複記錄；中途離開的局沒有結果
+    if (simulator.isOver() && options.replayPath.empty()) 
+    {
+        recordResult();
+    }
+
     // 停止 BGM
     audioManager.stopMusic();
 
-    // 現在才停音效 => 讓程式在結束前將音效殺掉
+    // 停止所有播放中的音效
     audioManager.stopSoundEffect();
 
-    std::cout << "[Game] Cleanup and exit.\n";
-}
-
-
-void Game::handleEvents() 
-{
-    inputHandler.processInput();
+    std::cout << "[Render] 發佈 " << renderThread.getPublishedFrames() << " 幀，實際繪製 "
+              << renderThread.getDrawnFrames() << " 幀\n";
 
-    if (inputHandler.isQuit()) 
+    if (inputLatencyCount > 0) 
     {
-        running = false;
-        return;
+        std::cout << "[Input] 輸入延遲 平均 " << inputLatencySumUs / inputLatencyCount / 1000.0
+                  << " ms, 最大 " << inputLatencyMaxUs / 1000.0 << " ms\n";
     }
 
-    auto now = std::chrono::steady_clock::now();
-
-    if (inputHandler.isMoveLeft()) 
+    if (!options.timingPath.empty()) 
     {
-        currentTetromino.moveLeft();
-        if (board.checkCollision(currentTetromino)) 
+        frameTimer.get(FramePhase::Draw) = renderThread.getDrawTimes();
+        if (frameTimer.dump(options.timingPath.c_str())) 
         {
-            currentTetromino.moveRight();
-        } 
+            std::cout << "[Timing] 各階段耗時已寫入 " << options.timingPath << "\n";
+        }
         else 
         {
-            if (std::chrono::duration<double>(now - lastMoveSoundTime).count() > SOUND_COOLDOWN) 
-            {
-                lastMoveSoundTime = now;
-            }
+            std::cout << "[Timing] 無法寫入 " << options.timingPath << "\n";
         }
     }
 
-    if (inputHandler.isMoveRight()) 
+    if (recorder.isRecording()) 
     {
-        currentTetromino.moveRight();
-        if (board.checkCollision(currentTetromino)) 
-        {
-            currentTetromino.moveLeft();
-        } 
-        else 
+        recorder.finish(simulator);
+        if (recorder.save(options.recordPath)) 
         {
-            if (std::chrono::duration<double>(now - lastMoveSoundTime).count() > SOUND_COOLDOWN) 
-            {
-                lastMoveSoundTime = now;
-            }
+            std::cout << "[Replay] 已儲存 " << options.recordPath << " (" << recorder.size() << " bytes)\n";
         }
     }
 
-    if (inputHandler.isRotateLeft()) 
+    if (!options.replayPath.empty()) 
     {
-        currentTetromino.rotateLeft();
-        if (board.checkCollision(currentTetromino)) 
+        const ReplayHeader& header = replayPlayer.getHeader();
+        uint64_t hash = hashGameState(simulator.getBoard(), simulator.getScoreManager());
+
+        if (simulator.getTick() < header.ticks && !simulator.isOver()) 
+        {
+            std::cout << "[Replay] 播放中斷於 tick " << simulator.getTick() << " / " << header.ticks << "\n";
+        }
+        else if (simulator.getTick() == header.ticks && hash == header.stateHash && !replayPlayer.isCorrupt()) 
         {
-            currentTetromino.rotateRight();
-        } 
+            std::cout << "[Replay] 結束狀態與錄製時一致\n";
+        }
         else 
         {
-            if (std::chrono::duration<double>(now - lastRotateSoundTime).count() > SOUND_COOLDOWN) 
-            {
-                lastRotateSoundTime = now;
-                audioManager.playRotateSound();
-            }
+            std::cout << "[Replay] 結束狀態與錄製時不一致 (tick " << simulator.getTick() << " / " << header.ticks << ")\n";
         }
     }
 
-    if (inputHandler.isRotateRight()) 
+    std::cout << "[Game] seed " << simulator.getSeed() << " (" << randomizerModeName(simulator.getRandomizerMode()) << ")\n";
+    std::cout << "[Game] Cleanup and exit.\n";
+}
+
+void Game::recordResult() 
+{
+    std::string path = options.scoresPath.empty() ? defaultLeaderboardPath(Board::WIDTH, Board::HEIGHT) : options.scoresPath;
+    Leaderboard leaderboard;
+    std::string error;
+    RunSource source = versus ? RunSource::Versus : (options.bot ? RunSource::Bot : RunSource::Human);
+    const ScoreManager& scoreManager = simulator.getScoreManager();
+    LeaderboardRecord record = makeLeaderboardRecord(scoreManager.getScore(), scoreManager.getLines(), simulator.getLevel(),
+                                                     simulator.getTick(), simulator.getSeed(),
+                                                     simulator.getRandomizerMode(), source);
+    if (!leaderboard.open(path, Board::WIDTH, Board::HEIGHT, error) || !leaderboard.append(record, error)) 
+    {
+        std::cout << "[Leaderboard] 無法記錄：" << error << "\n";
+        return;
+    }
+    std::cout << "[Leaderboard] 分數 " << record.score << "，第 " << leaderboard.rank(record.score) << " 名 / 共 "
+              << leaderboard.size() << " 局 (" << path << ")\n";
+}
+
+
+void Game::waitForNextEvent() 
+{
+    auto now = std::chrono::steady_clock::now();
+    if (now >= nextTick) 
     {
-        currentTetromino.rotateRight();
-        if (board.checkCollision(currentTetromino)) 
+        return;
+    }
+
+    // 無條件進位到毫秒，確保醒來時 tick 已經到期
+    auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(nextTick - now).count();
+    int timeoutMs = static_cast<int>((remaining + 999) / 1000);
+
+    bool ready = inputHandler.waitForInput(timeoutMs);
+    auto woke = std::chrono::steady_clock::now();
+    frameTimer.record(FramePhase::Idle, now, woke);
+
+    if (ready) 
+    {
+        handleEvents();
+        frameTimer.record(FramePhase::HandleEvents, woke, std::chrono::steady_clock::now());
+    }
+}
+
+void Game::handleEvents() 
+{
+    // 事件先留在佇列裡，到下一個 tick 才一起送進 Simulator。
+    // 標準輸入關閉 (例如 --bot < /dev/null) 後 InputHandler 不再 poll 它，waitForNextEvent() 直接睡到下一個 tick
+    inputHandler.processInput();
+}
+
+InputState Game::collectInput(std::chrono::steady_clock::time_point now) 
+{
+    inputHandler.expireEscape(now);
+
+    KeyEvent event;
+    while (inputHandler.pollEvent(event)) 
+    {
+        if (event.action == InputAction::Quit) 
         {
-            currentTetromino.rotateLeft();
-        } 
-        else 
+            running = false;
+            break;
+        }
+
+        if (options.bot || !options.replayPath.empty()) 
         {
-            if (std::chrono::duration<double>(now - lastRotateSoundTime).count() > SOUND_COOLDOWN) 
-            {
-                lastRotateSoundTime = now;
-                audioManager.playRotateSound();
-            }
+            continue;
         }
+
+        long long latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(now - event.time).count();
+        inputLatencySumUs += latencyUs;
+        inputLatencyCount++;
+        if (latencyUs > inputLatencyMaxUs) 
+        {
+            inputLatencyMaxUs = latencyUs;
+        }
+
+        keyRepeater.onKeyEvent(event);
     }
 
-    if (inputHandler.isMoveDown()) 
+    if (!options.replayPath.empty()) 
     {
-        currentTetromino.moveDown();
-        if (board.checkCollision(currentTetromino)) 
+        // 播完錄製的 tick 數就結束
+        if (simulator.getTick() >= replayPlayer.getHeader().ticks) 
         {
-            currentTetromino.moveUp(); 
-        } 
-        else 
+            running = false;
+            return unpackInput(0);
+        }
+        return replayPlayer.next(simulator.getTick());
+    }
+
+    if (options.bot) 
+    {
+        return bot.nextInput(simulator.getBoard(), simulator.getTetromino());
+    }
+
+    unsigned actions = keyRepeater.update(now);
+
+    InputState input;
+    input.moveLeft = actions & (1u << static_cast<int>(InputAction::MoveLeft));
+    input.moveRight = actions & (1u << static_cast<int>(InputAction::MoveRight));
+    input.rotateLeft = actions & (1u << static_cast<int>(InputAction::RotateLeft));
+    input.rotateRight = actions & (1u << static_cast<int>(InputAction::RotateRight));
+    input.moveDown = actions & (1u << static_cast<int>(InputAction::MoveDown));
+    input.hardDrop = actions & (1u << static_cast<int>(InputAction::HardDrop));
+    return input;
+}
+
+void Game::update() 
+{
+    const auto tickDuration = std::chrono::milliseconds(Simulator::TICK_MS);
+    auto now = std::chrono::steady_clock::now();
+
+    for (int i = 0; running && now >= nextTick; ++i) 
+    {
+        if (i == MAX_CATCHUP_TICKS) 
         {
-            if (std::chrono::duration<double>(now - lastMoveSoundTime).count() > SOUND_COOLDOWN) 
-            {
-                lastMoveSoundTime = now;
-            }
+            // 落後太多 (例如被暫停)，放棄追趕
+            nextTick = now;
+            break;
         }
+
+        nextTick += tickDuration;
+        step();
+    }
+}
+
+void Game::step() 
+{
+    InputState input = collectInput(std::chrono::steady_clock::now());
+    if (versus) 
+    {
+        // 離開也要經過交換，讓對手知道
+        versusStep(input);
+        return;
+    }
+    if (!running) 
+    {
+        return;
+    }
+
+    recorder.record(simulator.getTick(), input);
+
+    handleStepEvents(simulator.step(input));
+
+    // 幾百個位元組的複製，寫回磁碟交給核心，不會造成停頓
+    if (checkpoint.isOpen() && simulator.getTick() % CHECKPOINT_INTERVAL_TICKS == 0 && !simulator.isOver()) 
+    {
+        checkpoint.save(simulator, false);
     }
 }
 
-void Game::update() {
-    if (frameCount >= framesPerDrop) 
+void Game::versusStep(const InputState& input) 
+{
+    bool hosting = versusLink.isHost();
+    Simulator& host = hosting ? simulator : opponent;
+    Simulator& guest = hosting ? opponent : simulator;
+
+    uint64_t tick = simulator.getTick();
+    uint64_t hash = tick % VersusLink::HASH_INTERVAL == 0 ? hashVersusState(host, guest) : 0;
+    uint8_t local = static_cast<uint8_t>(packInput(input) | (running ? 0 : VERSUS_QUIT));
+    uint8_t remote = 0;
+    if (!versusLink.exchange(tick, local, hash, remote, versusError)) 
+    {
+        running = false;
+        return;
+    }
+    if (!running) 
     {
-        currentTetromino.moveDown();
-        frameCount = 0;  
+        return;
+    }
+    if (remote & VERSUS_QUIT) 
+    {
+        versusError = "對手離開了";
+        running = false;
+        return;
+    }
 
-        if (board.checkCollision(currentTetromino)) 
-        {
-            currentTetromino.moveUp();
-            board.placeTetromino(currentTetromino);
+    InputState remoteInput = unpackInput(remote);
+    StepEvents hostEvents;
+    StepEvents guestEvents;
+    stepVersus(host, guest, hosting ? input : remoteInput, hosting ? remoteInput : input, hostEvents, guestEvents);
 
-            int linesCleared = board.clearLines();
-            if (linesCleared > 0) 
-            {
-                scoreManager.addScore(linesCleared);
-                audioManager.playLineClearSound();
-            }
+    const StepEvents& opponentEvents = hosting ? guestEvents : hostEvents;
+    if (opponentEvents.moved || opponentEvents.rotated || opponentEvents.dropped || opponentEvents.locked) 
+    {
+        dirty = true;
+    }
+    if (opponent.isOver()) 
+    {
+        running = false;
+    }
 
-            if (level <= 10 && scoreManager.getScore() >= levelThresholds[level - 1]) 
-            {
-                nextLevel();
-            }
+    handleStepEvents(hosting ? hostEvents : guestEvents);
+}
 
-            TetrominoType randomType = static_cast<TetrominoType>(std::rand() % 7);
-            currentTetromino.reset(randomType);
+void Game::handleStepEvents(const StepEvents& events) 
+{
+    if (events.moved || events.rotated || events.dropped || events.locked) 
+    {
+        dirty = true;
+    }
 
-            if (board.checkCollision(currentTetromino)) 
-            {
-                running = false;
-            }
+    if (events.locked) 
+    {
+        bot.reset();
+    }
+
+    if (events.rotated) 
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(now - lastRotateSoundTime).count() > SOUND_COOLDOWN) 
+        {
+            lastRotateSoundTime = now;
+            audioManager.playRotateSound();
         }
-    } 
-    else 
+    }
+
+    if (events.lines.count > 0) 
     {
-        frameCount++;
+        audioManager.playLineClearSound();
+    }
+
+    if (events.levelUp) 
+    {
+        nextLevel();
+    }
+
+    if (events.gameOver) 
+    {
+        running = false;
     }
 }
 
-void Game::render() 
+void Game::render(int countdown) 
 {
-    if (level > 10) 
+    // 快照只是幾百個位元組的複製，不會被終端機的速度拖住
+    FrameSnapshot& snapshot = renderThread.beginFrame();
+    snapshot.board = simulator.getBoard();
+    snapshot.tetromino = simulator.getTetromino();
+    snapshot.scoreManager = simulator.getScoreManager();
+    snapshot.level = simulator.getLevel();
+    snapshot.countdown = countdown;
+    snapshot.versus = versus;
+    if (versus) 
     {
-        std::cout << "\n[Game Over] 你已完成所有關卡！感謝遊玩！\n";
-        return;
+        snapshot.opponentBoard = opponent.getBoard();
+        snapshot.opponentTetromino = opponent.getTetromino();
+        snapshot.opponentScore = opponent.getScoreManager().getScore();
+        snapshot.opponentLevel = opponent.getLevel();
+        snapshot.pendingGarbage = simulator.getPendingGarbage();
+        snapshot.opponentPendingGarbage = opponent.getPendingGarbage();
+    }
+    // 對戰時右側是對手的盤面，不顯示計時面板
+    snapshot.showTimings = !options.timingPath.empty() && !versus;
+    if (snapshot.showTimings) 
+    {
+        frameTimer.summarize(snapshot.timings);
     }
+    broadcast.publish(snapshot);
+    renderThread.publish();
+}
 
-    renderer.draw(board, currentTetromino, scoreManager, level);
+void Game::loadSettings() 
+{
+    std::string warnings;
+    bool loaded = loadConfig(options.configPath, config, warnings);
+    if (!warnings.empty()) 
+    {
+        // 遊戲中重載時訊息會蓋到畫面，之後整幀重畫
+        std::cerr << "[Config] " << warnings << (loaded ? "" : "\n");
+        renderThread.invalidate();
+    }
+    applyConfig();
+}
+
+void Game::applyConfig() 
+{
+    audioManager.configure(config);
+    inputHandler.setKeymap(config.keymap);
+    keyRepeater.configure(config.dasMs, config.arrMs, config.releaseMs);
+    renderThread.setMaxFps(config.renderFps);
+    renderThread.setBoardOffset(config.boardOffset);
+
+    // 重播檔頭沒有記錄難度曲線，錄製與重播時一律使用內建曲線；對戰時雙方也必須相同
+    if (options.recordPath.empty() && options.replayPath.empty() && !versus) 
+    {
+        simulator.setGravityMs(config.gravityMs);
+        simulator.setLevelThresholds(config.levelThresholds);
+    }
+    dirty = true;
 }
 
 void Game::nextLevel() 
 {
-    level++;
+    int level = simulator.getLevel();
 
-    if (level > 10) 
+    if (level > Simulator::MAX_LEVEL) 
     {
-        std::cout << "[Game Over] 你已完成所有關卡！\n";
         running = false;
         audioManager.stopMusic();
         return;
     }
 
-    std::cout << "[Level Up] 進入關卡 " << level << "!\n";
-
-    audioManager.stopMusic();  // 確保上一關的 BGM 停止
-    countdownBeforeStart();
-    audioManager.playMusic(level);  // 只會在新關卡時播放 BGM
-
-#ifndef TEST_MODE
-    if (framesPerDrop > 5) 
+    // 對戰時兩個盤面各自升級，不停下來倒數
+    if (!versus) 
     {
-        framesPerDrop -= 3;
+        // 關卡之間同步寫入存檔，反正接下來要倒數三秒
+        checkpoint.save(simulator, true);
+        audioManager.prepareMusic(level);  // 倒數期間預先解碼下一關的 BGM，上一關的 BGM 繼續播放
+        countdownBeforeStart();
     }
-#endif
+    audioManager.playMusic(level);  // 與上一關的 BGM 交叉淡化
 }
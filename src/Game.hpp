@@ -3,56 +3,139 @@
 
 #pragma once
 
-#include "Board.hpp"
-#include "Tetromino.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "Simulator.hpp"
 #include "InputHandler.hpp"
-#include "Renderer.hpp"
-#include "ScoreManager.hpp"
+#include "RenderThread.hpp"
 #include "AudioManager.hpp"
+#include "Bot.hpp"
+#include "Replay.hpp"
+#include "FrameTimer.hpp"
+#include "Config.hpp"
+#include "Versus.hpp"
+#include "Spectator.hpp"
+#include "Checkpoint.hpp"
+#include "Leaderboard.hpp"
 
+// 啟動選項 (由命令列參數決定)
+struct GameOptions 
+{
+    bool bot;                   // 由內建機器人自動遊玩 (--bot)，鍵盤只保留離開
+    bool hasSeed;               // 是否指定了種子 (--seed)；沒有時每次啟動隨機挑一個
+    uint64_t seed;
+    RandomizerMode randomizer;  // 方塊產生規則 (--randomizer)
+    std::string recordPath;     // 結束時把這一局存成重播檔 (--record)
+    std::string replayPath;     // 以實際速度播放重播檔 (--replay)，鍵盤只保留離開
+    std::string timingPath;     // 顯示各階段耗時，結束時寫出直方圖 (--timings)
+    std::string configPath;     // 設定檔 (--config)，空字串為 DEFAULT_CONFIG_PATH
+    std::string hostPath;       // 建立對戰並等待對手連線 (--host)
+    std::string joinPath;       // 連線到對戰主機 (--join)，種子與方塊產生規則由主機決定
+    std::string broadcastName;  // 把每一幀廣播到這個共享記憶體，給 --spectate 觀看 (--broadcast)
+    bool resume;                // 從存檔繼續上一局 (--resume)
+    std::string checkpointPath; // 存檔位置 (--checkpoint)，空字串為 DEFAULT_CHECKPOINT_PATH
+    std::string scoresPath;     // 成績記錄檔 (--scores)，空字串為 defaultLeaderboardPath()
+};
+
+// 互動式遊戲：負責終端機、音效與畫面，遊戲規則交給 Simulator
 class Game
 {
     private:
-        int frameCount;          // 計數器
-        int framesPerDrop;       // 多少「幀」執行一次 moveDown
         bool running;
+        bool dirty;              // 畫面是否需要重繪
+        bool versus;             // 雙人對戰 (--host / --join)
+        GameOptions options;
 
-        int level; // 當前關卡
+        // 下一個邏輯 tick 的時間點 (單調時鐘)
+        std::chrono::steady_clock::time_point nextTick;
 
-        #ifdef TEST_MODE
-        int levelThresholds[10] = {100, 100, 100, 100, 100, 100, 100, 100, 100, 100}; // 測試模式：每 100 分升級
-        #else
-        int levelThresholds[10] = {1000, 2500, 5000, 8000, 12000, 16000, 20000, 25000, 30000, 40000}; // 正式模式
-        #endif
-
-        Board board;
-        Tetromino currentTetromino;
+        Simulator simulator;
         InputHandler inputHandler;
-        Renderer renderer;
-        ScoreManager scoreManager;
+        KeyRepeater keyRepeater;
+
+        // 輸入延遲統計：按鍵事件的時間戳記到它被送進 Simulator 的時間
+        long long inputLatencySumUs;
+        long long inputLatencyMaxUs;
+        long long inputLatencyCount;
+        RenderThread renderThread;
         AudioManager audioManager;
+        Bot bot;
+
+        // 重播的錄製與播放
+        ReplayRecorder recorder;
+        ReplayFile replayFile;
+        ReplayPlayer replayPlayer;
+
+        // 設定檔與熱重載
+        Config config;
+        ConfigWatcher configWatcher;
+
+        // 主迴圈各階段的耗時 (繪製的部分由 RenderThread 統計)
+        FrameTimer frameTimer;
+
+        // 對戰：對手的盤面在本地以同樣的輸入模擬
+        Simulator opponent;
+        VersusLink versusLink;
+        std::string versusError;   // 斷線、逾時或不同步的原因
+
+        // 觀戰廣播 (寫入共享記憶體，不等待觀眾)
+        SpectatorBroadcast broadcast;
+
+        // 存檔：關卡之間與遊戲中定期寫入，結束 (堆滿或完成) 時作廢
+        Checkpoint checkpoint;
 
-        // 處理輸入事件
+        // 等待輸入或下一個 tick 到期 (閒置時不佔用 CPU)
+        void waitForNextEvent();
+
+        // 讀取終端機輸入並轉成事件
         void handleEvents();
 
-        // 更新遊戲邏輯
+        // 取出事件並經過 DAS/ARR 換算成本 tick 的輸入 (機器人模式改由 Bot 產生，重播模式由重播檔提供)
+        InputState collectInput(std::chrono::steady_clock::time_point now);
+
+        // 以固定時間步長追上目前時間，推進遊戲邏輯
         void update();
 
-        // 繪製畫面
-        void render();
+        // 推進單一 tick 並處理其事件
+        void step();
+
+        // 對戰：與對手交換輸入後推進兩個盤面
+        void versusStep(const InputState& input);
+
+        // 音效、關卡與結束等事件
+        void handleStepEvents(const StepEvents& events);
+
+        // 對戰：建立或加入連線，取得共同的種子
+        bool connectVersus();
+
+        // 開啟存檔；--resume 時還原上一局
+        void openCheckpoint();
+
+        // 把結束 (堆滿或完成) 的這一局寫進成績記錄並顯示名次
+        void recordResult();
+
+        // 發佈目前狀態給繪製執行緒 (countdown > 0 時顯示倒數)
+        void render(int countdown = 0);
+
+        // 讀取設定檔，成功時套用
+        void loadSettings();
+
+        // 把設定分派給各模組 (啟動時與設定檔變更時)
+        void applyConfig();
 
-        // 進入下一關
+        // 進入下一關 (BGM 與倒數)
         void nextLevel(); 
 
         // 每一關開始前倒數三秒
         void countdownBeforeStart();
 
     public:
-        Game();
+        explicit Game(const GameOptions& options = GameOptions());
         ~Game();
 
-        // 初始化遊戲（資源、變數、物件）
-        void init();
+        // 初始化遊戲（資源、變數、物件），重播檔無法讀取時回傳 false
+        bool init();
         
         // 進入主迴圈
         void run();
@@ -61,4 +144,4 @@ class Game
         void cleanup();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -3,18 +3,20 @@
 #include <unistd.h>   // for read(), STDIN_FILENO
 #include <termios.h>  // for struct termios, tcgetattr, tcsetattr
 #include <fcntl.h>    // for fcntl, O_NONBLOCK
+#include <poll.h>     // for poll()
 #include <errno.h>    // for EAGAIN, EWOULDBLOCK
 #include <cstdio>     // for perror()
 
 InputHandler::InputHandler()
-: moveLeft(false),
-  moveRight(false),
-  rotateLeft(false),
-  rotateRight(false),
-  moveDown(false),
-  quit(false),
-  origFlags(-1)
-{}
+: state(ParseState::Ground),
+  head(0),
+  count(0),
+  origFlags(-1),
+  termiosSaved(false),
+  inputClosed(false)
+{
+    defaultKeymap(keymap);
+}
 
 InputHandler::~InputHandler() 
 {
@@ -30,6 +32,7 @@ void InputHandler::initTerminal()
         perror("tcgetattr");
         return;
     }
+    termiosSaved = true;
 
     // 設定新的模式
     struct termios newTermios = origTermios;
@@ -71,18 +74,38 @@ void InputHandler::restoreTerminal()
         origFlags = -1;
     }
     // 恢復原先的 termios 設定
-    tcsetattr(STDIN_FILENO, TCSANOW, &origTermios);
+    if (termiosSaved) 
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &origTermios);
+        termiosSaved = false;
+    }
+}
+
+bool InputHandler::waitForInput(int timeoutMs) 
+{
+    struct pollfd pfd;
+    // 標準輸入關閉後以負的 fd 呼叫 poll：不監看任何東西，只睡到逾時
+    pfd.fd = inputClosed ? -1 : STDIN_FILENO;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    // 沒有輸入時就讓出 CPU，直到逾時或有按鍵進來
+    int ret = poll(&pfd, 1, timeoutMs < 0 ? 0 : timeoutMs);
+    if (ret > 0 && (pfd.revents & (POLLERR | POLLNVAL))) 
+    {
+        inputClosed = true;
+        return false;
+    }
+    // POLLHUP 也交給 processInput()：先讀完剩下的位元組，再由 read() 回傳 0 確認關閉
+    return ret > 0 && (pfd.revents & (POLLIN | POLLHUP));
 }
 
-void InputHandler::processInput() 
+bool InputHandler::processInput() 
 {
-    // 重置所有動作狀態
-    moveLeft = false;
-    moveRight = false;
-    rotateLeft = false;
-    rotateRight = false;
-    moveDown = false;
-    quit = false;
+    if (inputClosed) 
+    {
+        return false;
+    }
 
     // 利用非阻塞 read() 讀取所有可用字元
     char buffer[16];
@@ -95,115 +118,319 @@ void InputHandler::processInput()
 
         if (n > 0) 
         {
-            // 解析這些字元
-            for (int i = 0; i < n; ++i) 
-            {
-                char c = buffer[i];
-
-                if (c == '\x1B') 
-                {
-                    // 可能是 ESC or 方向鍵
-                    // 檢查後面兩個字元是否為 '[' 與 A/B/C/D
-                    // 這需要確保 buffer 中還有足夠字元可讀
-                    if ((i + 2) < n && buffer[i+1] == '[') 
-                    {
-                        char arrow = buffer[i+2];
-                        switch (arrow) 
-                        {
-                            case 'A': // Up arrow
-                                rotateRight = true;
-                                break;
-                            case 'B': // Down arrow
-                                moveDown = true;
-                                break;
-                            case 'C': // Right arrow
-                                moveRight = true;
-                                break;
-                            case 'D': // Left arrow
-                                moveLeft = true;
-                                break;
-                            default:
-                                break;
-                        }
-                        // 跳過後面兩個字元
-                        i += 2;
-                    } 
-                    else 
-                    {
-                        // 單純 ESC (27) 沒有後續，可能要退出或不處理
-                        quit = true;
-                    }
-                }
-                else 
-                {
-                    // 一般字元
-                    switch (c) 
-                    {
-                        case 'a':
-                            moveLeft = true;
-                            break;
-                        case 'd':
-                            moveRight = true;
-                            break;
-                        case 'q':
-                            rotateLeft = true;
-                            break;
-                        case 'e':
-                            rotateRight = true;
-                            break;
-                        case 's':
-                            moveDown = true;
-                            break;
-                        case 'x':
-                            quit = true;
-                            break;
-                        default:
-                            // 其他按鍵不處理
-                            break;
-                    }
-                }
-            }
+            // 同一次 read() 讀到的位元組共用同一個時間戳記
+            feed(buffer, n, std::chrono::steady_clock::now());
         }
         else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) 
         {
             // 沒有更多可讀資料，非阻塞狀態下直接跳出
-            break;
+            return true;
+        }
+        else if (n == -1 && errno == EINTR) 
+        {
+            continue;
         }
         else 
         {
-            // 其他錯誤，或 EOF
-            // 有時候 Ctrl+D (EOF) 也會進到這裡，可以視情況做處理
+            // EOF (導向 /dev/null、管線的寫入端關閉) 或其他錯誤 (終端機斷線)：之後不再讀取
+            inputClosed = true;
+            return false;
+        }
+    }
+}
+
+void InputHandler::feed(const char* bytes, int n, std::chrono::steady_clock::time_point time) 
+{
+    for (int i = 0; i < n; ++i) 
+    {
+        parseByte(bytes[i], time);
+    }
+}
+
+void InputHandler::parseByte(char c, std::chrono::steady_clock::time_point time) 
+{
+    switch (state) 
+    {
+        case ParseState::Escape:
+            if (c == '[') 
+            {
+                state = ParseState::Csi;
+                return;
+            }
+            if (c == 'O') 
+            {
+                state = ParseState::Ss3;
+                return;
+            }
+            if (c == '\x1B') 
+            {
+                // 連續兩個 ESC (Alt+ESC 或快速連按)：以第二個重新計時，逾時後才離開
+                escapeTime = time;
+                return;
+            }
+            state = ParseState::Ground;
+            if (c >= 0x20 && c <= 0x7E) 
+            {
+                // ESC + 可見字元是 Alt (meta) 組合鍵：整組丟掉，不當成離開
+                return;
+            }
+            // ESC 後面接其他控制字元：丟掉 ESC，這個字元重新當一般字元解析
+            parseByte(c, time);
+            return;
+
+        case ParseState::Csi:
+        case ParseState::Ss3:
+            // 參數 (0x30~0x3F) 與中間字元 (0x20~0x2F) 略過，直到結尾字元 (0x40~0x7E)
+            if (c >= 0x20 && c <= 0x3F) 
+            {
+                return;
+            }
+            state = ParseState::Ground;
+            switch (c) 
+            {
+                case 'A': // Up arrow
+                    pushEvent(InputAction::RotateRight, time);
+                    break;
+                case 'B': // Down arrow
+                    pushEvent(InputAction::MoveDown, time);
+                    break;
+                case 'C': // Right arrow
+                    pushEvent(InputAction::MoveRight, time);
+                    break;
+                case 'D': // Left arrow
+                    pushEvent(InputAction::MoveLeft, time);
+                    break;
+                default:
+                    // 其他序列 (功能鍵等) 不處理
+                    break;
+            }
+            return;
+
+        case ParseState::Ground:
             break;
+    }
+
+    if (c == '\x1B') 
+    {
+        // 可能是 ESC or 方向鍵，等後續字元 (可能在下一次 read() 才到) 再決定
+        state = ParseState::Escape;
+        escapeTime = time;
+        return;
+    }
+
+    // 一般字元：查表
+    unsigned char key = static_cast<unsigned char>(c);
+    if (key < KEYMAP_SIZE && keymap[key] >= 0) 
+    {
+        pushEvent(static_cast<InputAction>(keymap[key]), time);
+    }
+}
+
+void InputHandler::setKeymap(const int8_t (&map)[KEYMAP_SIZE]) 
+{
+    for (int i = 0; i < KEYMAP_SIZE; ++i) 
+    {
+        keymap[i] = map[i];
+    }
+}
+
+void InputHandler::defaultKeymap(int8_t (&map)[KEYMAP_SIZE]) 
+{
+    for (int i = 0; i < KEYMAP_SIZE; ++i) 
+    {
+        map[i] = -1;
+    }
+    map['a'] = static_cast<int8_t>(InputAction::MoveLeft);
+    map['d'] = static_cast<int8_t>(InputAction::MoveRight);
+    map['q'] = static_cast<int8_t>(InputAction::RotateLeft);
+    map['e'] = static_cast<int8_t>(InputAction::RotateRight);
+    map['s'] = static_cast<int8_t>(InputAction::MoveDown);
+    map[' '] = static_cast<int8_t>(InputAction::HardDrop);
+    map['x'] = static_cast<int8_t>(InputAction::Quit);
+}
+
+void InputHandler::expireEscape(std::chrono::steady_clock::time_point now) 
+{
+    if (state == ParseState::Escape && 
+        now - escapeTime >= std::chrono::milliseconds(ESCAPE_TIMEOUT_MS)) 
+    {
+        // 單純 ESC (27) 沒有後續 => 退出
+        pushEvent(InputAction::Quit, escapeTime);
+        state = ParseState::Ground;
+    }
+}
+
+void InputHandler::pushEvent(InputAction action, std::chrono::steady_clock::time_point time) 
+{
+    if (count == EVENT_CAPACITY) 
+    {
+        // 佇列已滿：丟掉最舊的非離開事件 (離開永遠不丟)，後面的事件往前補
+        int victim = 0;
+        while (victim < count && events[(head + victim) % EVENT_CAPACITY].action == InputAction::Quit) 
+        {
+            victim++;
+        }
+        if (victim == count) 
+        {
+            // 整個佇列都是離開：新的事件不會改變結果
+            return;
+        }
+        for (int i = victim; i + 1 < count; ++i) 
+        {
+            events[(head + i) % EVENT_CAPACITY] = events[(head + i + 1) % EVENT_CAPACITY];
         }
+        count--;
     }
+
+    KeyEvent& event = events[(head + count) % EVENT_CAPACITY];
+    event.action = action;
+    event.time = time;
+    count++;
 }
 
-bool InputHandler::isMoveLeft() const 
+bool InputHandler::pollEvent(KeyEvent& event) 
 {
-    return moveLeft;
+    if (count == 0) 
+    {
+        return false;
+    }
+
+    event = events[head];
+    head = (head + 1) % EVENT_CAPACITY;
+    count--;
+    return true;
 }
 
-bool InputHandler::isMoveRight() const 
+// ---- KeyRepeater ----
+
+// 終端機第一次自動重複前的最長延遲，超過這麼久才再收到同一鍵就當成新的一次按下
+static const int REPEAT_DELAY_MAX_MS = 700;
+
+KeyRepeater::KeyRepeater()
+: dasMs(DEFAULT_DAS_MS),
+  arrMs(DEFAULT_ARR_MS),
+  releaseMs(DEFAULT_RELEASE_MS)
 {
-    return moveRight;
+    for (int i = 0; i < REPEATABLE; ++i) 
+    {
+        keys[i].pressed = false;
+        keys[i].confirmed = false;
+    }
+    for (int i = 0; i < ACTIONS; ++i) 
+    {
+        pending[i] = 0;
+    }
 }
 
-bool InputHandler::isRotateLeft() const 
+void KeyRepeater::configure(int das, int arr, int release) 
 {
-    return rotateLeft;
+    dasMs = das;
+    arrMs = arr;
+    releaseMs = release;
 }
 
-bool InputHandler::isRotateRight() const 
+void KeyRepeater::release(int index) 
 {
-    return rotateRight;
+    keys[index].pressed = false;
+    keys[index].confirmed = false;
 }
 
-bool InputHandler::isMoveDown() const 
+void KeyRepeater::onKeyEvent(const KeyEvent& event) 
 {
-    return moveDown;
+    int index = static_cast<int>(event.action);
+
+    // 旋轉與離開不做自動重複，每個事件就是一次動作
+    if (index >= REPEATABLE) 
+    {
+        pending[index]++;
+        return;
+    }
+
+    HeldKey& key = keys[index];
+    auto gap = event.time - key.lastSeen;
+
+    if (!key.pressed || gap > std::chrono::milliseconds(REPEAT_DELAY_MAX_MS)) 
+    {
+        // 新的一次按下：立刻動作一次，並放開反方向鍵
+        key.pressed = true;
+        key.confirmed = false;
+        key.nextRepeat = event.time + std::chrono::milliseconds(dasMs);
+        pending[index]++;
+
+        if (event.action == InputAction::MoveLeft) 
+        {
+            release(static_cast<int>(InputAction::MoveRight));
+        }
+        else if (event.action == InputAction::MoveRight) 
+        {
+            release(static_cast<int>(InputAction::MoveLeft));
+        }
+    }
+    else if (!key.confirmed) 
+    {
+        if (gap <= std::chrono::milliseconds(releaseMs)) 
+        {
+            // 間隔很短 => 終端機的自動重複 (或同一次讀到的連按)，這個位元組本身照常動作一次，
+            // 之後確認為按住，改由我們的時鐘決定重複節奏
+            key.confirmed = true;
+            pending[index]++;
+            if (key.nextRepeat < event.time + std::chrono::milliseconds(arrMs)) 
+            {
+                key.nextRepeat = event.time + std::chrono::milliseconds(arrMs);
+            }
+        }
+        else 
+        {
+            // 手動連按 (或終端機延遲後的第一次重複)：再動作一次
+            pending[index]++;
+        }
+    }
+
+    key.lastSeen = event.time;
 }
 
-bool InputHandler::isQuit() const 
+unsigned KeyRepeater::update(std::chrono::steady_clock::time_point now) 
 {
-    return quit;
+    for (int i = 0; i < REPEATABLE; ++i) 
+    {
+        HeldKey& key = keys[i];
+        if (!key.pressed) 
+        {
+            continue;
+        }
+
+        int timeoutMs = key.confirmed ? releaseMs : REPEAT_DELAY_MAX_MS;
+        if (now - key.lastSeen > std::chrono::milliseconds(timeoutMs)) 
+        {
+            // 太久沒收到此鍵 => 視為放開
+            release(i);
+            continue;
+        }
+
+        if (key.confirmed && now >= key.nextRepeat) 
+        {
+            // 自動重複不累積：上一次還沒送出就不再加
+            if (pending[i] == 0) 
+            {
+                pending[i] = 1;
+            }
+            key.nextRepeat += std::chrono::milliseconds(arrMs);
+            if (key.nextRepeat < now) 
+            {
+                // 不補發落後的重複，避免一次衝好幾格
+                key.nextRepeat = now + std::chrono::milliseconds(arrMs);
+            }
+        }
+    }
+
+    unsigned actions = 0;
+    for (int i = 0; i < ACTIONS; ++i) 
+    {
+        if (pending[i] > 0) 
+        {
+            actions |= 1u << i;
+            pending[i]--;
+        }
+    }
+    return actions;
 }
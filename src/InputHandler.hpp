@@ -2,23 +2,65 @@
 #define INPUTHANDLER
 
 #include <termios.h>  // 需要包含這個，才用得到 struct termios
+#include <chrono>
+#include <cstdint>
 
 #pragma once
 
+// 按鍵解析後對應到的遊戲動作
+// 前三個是可自動重複的動作 (KeyRepeater 依編號判斷)
+enum class InputAction 
+{
+    MoveLeft, MoveRight, MoveDown, RotateLeft, RotateRight, HardDrop, Quit
+};
+
+// 帶時間戳記的按鍵事件 (時間為讀到該位元組的時間點)
+struct KeyEvent 
+{
+    InputAction action;
+    std::chrono::steady_clock::time_point time;
+};
+
 class InputHandler 
 {
+    public:
+        static const int KEYMAP_SIZE = 128;     // 一般按鍵只對應 ASCII 字元
+
     private:
-        bool moveLeft;
-        bool moveRight;
-        bool rotateLeft;
-        bool rotateRight;
-        bool moveDown;
-        bool quit;
+        // 跳脫序列解析狀態：跨越多次 read() 也能保留
+        enum class ParseState 
+        {
+            Ground,     // 一般字元
+            Escape,     // 收到 ESC，等待 '[' / 'O' (方向鍵)、可見字元 (Alt 組合鍵，丟掉) 或逾時 (離開)
+            Csi,        // 收到 ESC [，等待參數與結尾字元
+            Ss3         // 收到 ESC O (application cursor 模式的方向鍵)
+        };
+
+        static const int EVENT_CAPACITY = 64;   // 事件佇列容量 (滿了丟最舊的非離開事件)
+        static const int ESCAPE_TIMEOUT_MS = 50; // 單獨 ESC 的判定時間
+
+        ParseState state;
+        std::chrono::steady_clock::time_point escapeTime;
+
+        // 一般字元 -> InputAction 編號 (-1 表示不處理)；方向鍵與 ESC 固定
+        int8_t keymap[KEYMAP_SIZE];
+
+        // 固定容量的環狀事件佇列
+        KeyEvent events[EVENT_CAPACITY];
+        int head;
+        int count;
 
         // 用來保存原先的 termios 設定，方便離開遊戲時恢復
         int origFlags;
+        bool termiosSaved;       // origTermios 是否有效 (沒有 initTerminal() 過就不必恢復)
         struct termios origTermios;
 
+        // 標準輸入已到 EOF 或斷線 (例如 --bot < /dev/null)：之後不再 poll 它，否則 poll 會一直立刻回傳
+        bool inputClosed;
+
+        void pushEvent(InputAction action, std::chrono::steady_clock::time_point time);
+        void parseByte(char c, std::chrono::steady_clock::time_point time);
+
     public:
         InputHandler();
         ~InputHandler();
@@ -28,15 +70,74 @@ class InputHandler
         // 恢復終端模式
         void restoreTerminal();
 
-        // 主要用來偵測按鍵狀態
-        void processInput();
+        // 阻塞等待標準輸入可讀，最多 timeoutMs 毫秒；有輸入 (或 EOF、斷線) 時回傳 true。
+        // 標準輸入關閉之後只睡滿 timeoutMs
+        bool waitForInput(int timeoutMs);
+
+        // 讀取所有可用的位元組並轉成事件；碰到 EOF 或斷線時回傳 false
+        bool processInput();
+
+        // 直接餵入位元組 (不經過終端機)，供測試與重播使用
+        void feed(const char* bytes, int n, std::chrono::steady_clock::time_point time);
+
+        // 若 ESC 之後逾時沒有後續字元，視為單獨的 ESC (離開)
+        void expireEscape(std::chrono::steady_clock::time_point now);
+
+        // 取出最早的事件，佇列為空時回傳 false
+        bool pollEvent(KeyEvent& event);
+
+        // 更換一般按鍵的對應 (下一個位元組開始生效)
+        void setKeymap(const int8_t (&map)[KEYMAP_SIZE]);
+
+        // 預設對應：a/d 平移、q/e 旋轉、s 下移、空白鍵硬降、x 離開
+        static void defaultKeymap(int8_t (&map)[KEYMAP_SIZE]);
+};
+
+// 以遊戲自己的時鐘實作 DAS (delayed auto-shift) 與 ARR (auto-repeat rate)。
+// 終端機只會送出按下 (以及自動重複) 的位元組，沒有放開事件：
+// 第二個相同按鍵進來才確認是「按住」，之後一段時間沒再收到就視為放開。
+class KeyRepeater 
+{
+    public:
+        // 可重複的動作數量 (MoveLeft、MoveRight、MoveDown)
+        static const int REPEATABLE = 3;
+        // 所有動作的數量
+        static const int ACTIONS = 7;
+
+        // 預設的 DAS / ARR / 放開判定時間 (毫秒)
+        static const int DEFAULT_DAS_MS = 170;
+        static const int DEFAULT_ARR_MS = 50;
+        static const int DEFAULT_RELEASE_MS = 120;
+
+    private:
+        struct HeldKey 
+        {
+            bool pressed;         // 目前是否按著
+            bool confirmed;       // 是否已收到終端機的自動重複 (確認為按住)
+            std::chrono::steady_clock::time_point lastSeen;    // 最後一次收到此鍵
+            std::chrono::steady_clock::time_point nextRepeat;  // 下一次自動重複的時間點
+        };
+
+        int dasMs;          // 按住多久後開始自動重複
+        int arrMs;          // 自動重複的間隔
+        int releaseMs;      // 多久沒收到重複位元組就視為放開
+
+        HeldKey keys[REPEATABLE];
+        int pending[ACTIONS];   // 每個動作尚未送出的次數，每個 tick 最多送出一次
+
+        void release(int index);
+
+    public:
+        KeyRepeater();
+
+        // 設定 DAS / ARR / 放開判定時間 (毫秒)
+        void configure(int dasMs, int arrMs, int releaseMs);
+
+        // 處理一個按鍵事件
+        void onKeyEvent(const KeyEvent& event);
 
-        bool isMoveLeft() const;
-        bool isMoveRight() const;
-        bool isRotateLeft() const;
-        bool isRotateRight() const;
-        bool isMoveDown() const;
-        bool isQuit() const;
+        // 依目前時間產生本 tick 要執行的動作，回傳位元遮罩
+        unsigned update(std::chrono::steady_clock::time_point now);
 };
 
-#endif
\ No newline at end of file
+#endif
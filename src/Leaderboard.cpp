@@ -0,0 +1,689 @@
+#include "Leaderboard.hpp"
+#include "FileFormat.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char LEADERBOARD_MAGIC[4] = { 'O', 'B', 'L', 'B' };
+
+    // 新檔案的容量 (約 160 KB 的記錄)，之後每次用完加倍
+    const uint64_t INITIAL_CAPACITY = 4096;
+
+    // 記錄編號 + 1 以 32-bit 存放
+    const uint64_t MAX_CAPACITY = 0xFFFFFFFEull;
+
+    static_assert((LEADERBOARD_BUCKETS & (LEADERBOARD_BUCKETS - 1)) == 0, "LEADERBOARD_BUCKETS 必須是 2 的冪次");
+    static_assert(sizeof(LeaderboardHeader) == 64, "LeaderboardHeader 必須是 64 位元組");
+    static_assert(sizeof(LeaderboardIndex) % 8 == 0, "記錄必須對齊 8 位元組");
+
+    size_t fileSize(uint64_t capacity)
+    {
+        return sizeof(LeaderboardHeader) + sizeof(LeaderboardIndex) + capacity * sizeof(LeaderboardRecord);
+    }
+
+    int bucketOf(int score)
+    {
+        if (score < 0)
+        {
+            return 0;
+        }
+        return std::min(score / LEADERBOARD_BUCKET_WIDTH, LEADERBOARD_BUCKETS - 1);
+    }
+
+    // 結束關卡 1 ~ LEADERBOARD_LEVELS 對應到 byLevel 的索引
+    int levelSlot(int level)
+    {
+        return std::max(1, std::min(level, LEADERBOARD_LEVELS)) - 1;
+    }
+
+    // 持有 flock 直到離開作用域 (同一個行程內的不同 fd 也會互斥)
+    class FileLock
+    {
+        private:
+            int fd;
+
+        public:
+            FileLock(int fd, int operation)
+            : fd(fd)
+            {
+                while (flock(fd, operation) == -1 && errno == EINTR)
+                {}
+            }
+
+            ~FileLock()
+            {
+                flock(fd, LOCK_UN);
+            }
+    };
+
+    // 當掉時只保證 mmap 內的寫入依序發生：不讓編譯器把 dirty 的設定與索引的更新重新排序
+    void orderWrites()
+    {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+}
+
+const char* runSourceName(RunSource source)
+{
+    switch (source)
+    {
+        case RunSource::Human:    return "human";
+        case RunSource::Bot:      return "bot";
+        case RunSource::Versus:   return "versus";
+        case RunSource::Headless: return "headless";
+    }
+    return "?";
+}
+
+Leaderboard::Leaderboard()
+: fd(-1),
+  mapping(nullptr),
+  mappedSize(0),
+  header(nullptr),
+  index(nullptr),
+  records(nullptr)
+{}
+
+Leaderboard::~Leaderboard()
+{
+    close();
+}
+
+bool Leaderboard::map(size_t size, std::string& error)
+{
+    unmap();
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED)
+    {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+    mapping = address;
+    mappedSize = size;
+    uint8_t* base = static_cast<uint8_t*>(address);
+    header = reinterpret_cast<LeaderboardHeader*>(base);
+    index = reinterpret_cast<LeaderboardIndex*>(base + sizeof(LeaderboardHeader));
+    records = reinterpret_cast<LeaderboardRecord*>(base + sizeof(LeaderboardHeader) + sizeof(LeaderboardIndex));
+    return true;
+}
+
+void Leaderboard::unmap()
+{
+    if (mapping)
+    {
+        munmap(mapping, mappedSize);
+        mapping = nullptr;
+        mappedSize = 0;
+        header = nullptr;
+        index = nullptr;
+        records = nullptr;
+    }
+}
+
+bool Leaderboard::refresh()
+{
+    if (!mapping)
+    {
+        return false;
+    }
+    if (fileSize(header->capacity) <= mappedSize)
+    {
+        return true;
+    }
+
+    struct stat info;
+    std::string error;
+    if (fstat(fd, &info) == -1 || static_cast<size_t>(info.st_size) < fileSize(header->capacity))
+    {
+        return false;
+    }
+    return map(static_cast<size_t>(info.st_size), error);
+}
+
+bool Leaderboard::open(const std::string& filePath, int boardWidth, int boardHeight, std::string& error)
+{
+    close();
+    path = filePath;
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1)
+    {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    bool ok;
+    {
+        // 建立新檔案或重建索引時，其他行程不能同時使用
+        FileLock lock(fd, LOCK_EX);
+        ok = initialize(boardWidth, boardHeight, error);
+    }
+    if (!ok)
+    {
+        close();
+    }
+    return ok;
+}
+
+bool Leaderboard::initialize(int boardWidth, int boardHeight, std::string& error)
+{
+    struct stat info;
+    if (fstat(fd, &info) == -1)
+    {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    if (info.st_size == 0)
+    {
+        if (boardWidth == 0 || boardHeight == 0)
+        {
+            error = path + ": no records";
+            return false;
+        }
+        // ftruncate 之後內容全為 0：索引是空的
+        if (ftruncate(fd, fileSize(INITIAL_CAPACITY)) == -1 || !map(fileSize(INITIAL_CAPACITY), error))
+        {
+            if (error.empty())
+            {
+                error = path + ": " + std::strerror(errno);
+            }
+            return false;
+        }
+        header->version = LEADERBOARD_VERSION;
+        header->flags = BUILD_FLAGS;
+        header->boardWidth = static_cast<uint16_t>(boardWidth);
+        header->boardHeight = static_cast<uint16_t>(boardHeight);
+        header->recordSize = sizeof(LeaderboardRecord);
+        header->bucketWidth = LEADERBOARD_BUCKET_WIDTH;
+        header->buckets = LEADERBOARD_BUCKETS;
+        header->levels = LEADERBOARD_LEVELS;
+        header->indexSize = sizeof(LeaderboardIndex);
+        header->capacity = INITIAL_CAPACITY;
+        orderWrites();
+        std::memcpy(header->magic, LEADERBOARD_MAGIC, sizeof(header->magic));
+        return true;
+    }
+
+    // 已有的記錄不會被清空：格式不符時拒絕開啟
+    if (static_cast<size_t>(info.st_size) < fileSize(0))
+    {
+        error = path + ": not an oblivionis leaderboard";
+        return false;
+    }
+    if (!map(static_cast<size_t>(info.st_size), error))
+    {
+        return false;
+    }
+    if (std::memcmp(header->magic, LEADERBOARD_MAGIC, sizeof(header->magic)) != 0)
+    {
+        error = path + ": not an oblivionis leaderboard";
+        return false;
+    }
+    if (header->version != LEADERBOARD_VERSION || header->recordSize != sizeof(LeaderboardRecord)
+        || header->bucketWidth != LEADERBOARD_BUCKET_WIDTH || header->buckets != LEADERBOARD_BUCKETS
+        || header->levels != LEADERBOARD_LEVELS || header->indexSize != sizeof(LeaderboardIndex))
+    {
+        error = path + ": leaderboard from a different version";
+        return false;
+    }
+    if (header->flags != BUILD_FLAGS)
+    {
+        error = path + ((header->flags & BUILD_FLAG_TEST_MODE) ? ": recorded in test mode" : ": not recorded in test mode");
+        return false;
+    }
+    if ((boardWidth != 0 && header->boardWidth != boardWidth) || (boardHeight != 0 && header->boardHeight != boardHeight))
+    {
+        error = path + ": recorded on a " + std::to_string(header->boardWidth) + "x" + std::to_string(header->boardHeight) + " board";
+        return false;
+    }
+    if (header->count > header->capacity || static_cast<size_t>(info.st_size) < fileSize(header->capacity))
+    {
+        error = path + ": truncated";
+        return false;
+    }
+
+    if (header->dirty)
+    {
+        rebuild();
+    }
+    return true;
+}
+
+void Leaderboard::close()
+{
+    unmap();
+    if (fd != -1)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool Leaderboard::isOpen() const
+{
+    return mapping != nullptr;
+}
+
+int Leaderboard::getBoardWidth() const
+{
+    return header ? header->boardWidth : 0;
+}
+
+int Leaderboard::getBoardHeight() const
+{
+    return header ? header->boardHeight : 0;
+}
+
+void Leaderboard::insert(uint32_t id)
+{
+    LeaderboardRecord& record = records[id];
+    int bucket = bucketOf(record.score);
+
+    uint32_t& head = record.score == bucket * LEADERBOARD_BUCKET_WIDTH ? index->head[bucket] : index->offGrid[bucket];
+    record.next = head;
+    head = id + 1;
+
+    uint32_t* level = index->byLevel[levelSlot(record.level)];
+    for (int i = bucket + 1; i <= LEADERBOARD_BUCKETS; i += i & -i)
+    {
+        index->all[i - 1]++;
+        level[i - 1]++;
+    }
+}
+
+void Leaderboard::rebuild()
+{
+    header->dirty = 1;
+    orderWrites();
+    std::memset(static_cast<void*>(index), 0, sizeof(LeaderboardIndex));
+    for (uint64_t id = 0; id < header->count; ++id)
+    {
+        insert(static_cast<uint32_t>(id));
+    }
+    orderWrites();
+    header->dirty = 0;
+}
+
+bool Leaderboard::append(const LeaderboardRecord& record, std::string& error)
+{
+    if (!mapping)
+    {
+        error = "leaderboard is not open";
+        return false;
+    }
+
+    FileLock lock(fd, LOCK_EX);
+    if (!refresh())
+    {
+        error = path + ": cannot map";
+        return false;
+    }
+
+    if (header->count == header->capacity)
+    {
+        if (header->capacity >= MAX_CAPACITY)
+        {
+            error = path + ": full";
+            return false;
+        }
+        uint64_t capacity = std::min(header->capacity * 2, MAX_CAPACITY);
+        if (ftruncate(fd, fileSize(capacity)) == -1)
+        {
+            error = path + ": " + std::strerror(errno);
+            return false;
+        }
+        if (!map(fileSize(capacity), error))
+        {
+            return false;
+        }
+        header->capacity = capacity;
+    }
+
+    // 先寫記錄再更新索引；count 增加之前當掉時這筆記錄不存在
+    uint32_t id = static_cast<uint32_t>(header->count);
+    records[id] = record;
+    orderWrites();
+    header->dirty = 1;
+    orderWrites();
+    insert(id);
+    header->count = id + 1;
+    orderWrites();
+    header->dirty = 0;
+    return true;
+}
+
+uint64_t Leaderboard::size()
+{
+    if (!mapping)
+    {
+        return 0;
+    }
+    FileLock lock(fd, LOCK_SH);
+    return refresh() ? header->count : 0;
+}
+
+const uint32_t* Leaderboard::tree(int level) const
+{
+    return level == 0 ? index->all : index->byLevel[levelSlot(level)];
+}
+
+uint64_t Leaderboard::prefix(const uint32_t* tree, int bucket)
+{
+    // 第 0 ~ bucket 桶的局數
+    uint64_t sum = 0;
+    for (int i = bucket + 1; i > 0; i -= i & -i)
+    {
+        sum += tree[i - 1];
+    }
+    return sum;
+}
+
+uint64_t Leaderboard::bucketCount(const uint32_t* tree, int bucket)
+{
+    return prefix(tree, bucket) - (bucket > 0 ? prefix(tree, bucket - 1) : 0);
+}
+
+int Leaderboard::findBucket(const uint32_t* tree, uint64_t position)
+{
+    // 由低分往高分數第 position 局所在的桶：由上往下走 Fenwick tree，O(log 桶數)
+    int bucket = 0;
+    for (int step = LEADERBOARD_BUCKETS; step > 0; step >>= 1)
+    {
+        if (bucket + step <= LEADERBOARD_BUCKETS && tree[bucket + step - 1] < position)
+        {
+            bucket += step;
+            position -= tree[bucket - 1];
+        }
+    }
+    return bucket;
+}
+
+void Leaderboard::offGrid(int bucket, int level, std::vector<LeaderboardRecord>& out) const
+{
+    out.clear();
+    for (uint32_t id = index->offGrid[bucket]; id != 0; id = records[id - 1].next)
+    {
+        const LeaderboardRecord& record = records[id - 1];
+        if (level == 0 || levelSlot(record.level) == levelSlot(level))
+        {
+            out.push_back(record);
+        }
+    }
+}
+
+void Leaderboard::collect(int bucket, size_t limit, std::vector<LeaderboardRecord>& out) const
+{
+    std::vector<LeaderboardRecord> others;
+    offGrid(bucket, 0, others);
+    std::stable_sort(others.begin(), others.end(),
+                     [](const LeaderboardRecord& a, const LeaderboardRecord& b) { return a.score > b.score; });
+
+    // 比桶的分數高的零散記錄、桶的分數 (串列本身由新到舊，只需要走 limit 步)、比它低的零散記錄
+    int base = bucket * LEADERBOARD_BUCKET_WIDTH;
+    size_t i = 0;
+    for (; i < others.size() && others[i].score > base && limit > 0; ++i, --limit)
+    {
+        out.push_back(others[i]);
+    }
+    for (uint32_t id = index->head[bucket]; id != 0 && limit > 0; id = records[id - 1].next, --limit)
+    {
+        out.push_back(records[id - 1]);
+    }
+    for (; i < others.size() && limit > 0; ++i, --limit)
+    {
+        out.push_back(others[i]);
+    }
+}
+
+int Leaderboard::scoreAt(int bucket, int level, uint64_t position) const
+{
+    std::vector<LeaderboardRecord> others;
+    offGrid(bucket, level, others);
+    std::vector<int> scores;
+    for (size_t i = 0; i < others.size(); ++i)
+    {
+        scores.push_back(others[i].score);
+    }
+    std::sort(scores.begin(), scores.end());
+
+    // 由低到高：比桶的分數低的零散記錄、剛好是桶分數的局、比它高的零散記錄
+    int base = bucket * LEADERBOARD_BUCKET_WIDTH;
+    uint64_t below = std::lower_bound(scores.begin(), scores.end(), base) - scores.begin();
+    uint64_t exact = bucketCount(tree(level), bucket) - scores.size();
+    if (position <= below)
+    {
+        return scores[position - 1];
+    }
+    if (position <= below + exact || scores.empty())
+    {
+        return base;
+    }
+    return scores[std::min<uint64_t>(position - exact, scores.size()) - 1];
+}
+
+uint64_t Leaderboard::rank(int score)
+{
+    if (!mapping)
+    {
+        return 1;
+    }
+    FileLock lock(fd, LOCK_SH);
+    if (!refresh())
+    {
+        return 1;
+    }
+
+    int bucket = bucketOf(score);
+    uint64_t above = prefix(index->all, LEADERBOARD_BUCKETS - 1) - prefix(index->all, bucket);
+    std::vector<LeaderboardRecord> others;
+    offGrid(bucket, 0, others);
+    if (bucket * LEADERBOARD_BUCKET_WIDTH > score)
+    {
+        above += bucketCount(index->all, bucket) - others.size();
+    }
+    for (size_t i = 0; i < others.size(); ++i)
+    {
+        above += others[i].score > score;
+    }
+    return above + 1;
+}
+
+void Leaderboard::top(size_t k, std::vector<LeaderboardRecord>& out)
+{
+    out.clear();
+    if (!mapping)
+    {
+        return;
+    }
+    FileLock lock(fd, LOCK_SH);
+    if (!refresh())
+    {
+        return;
+    }
+
+    // 從最高分的桶往下取，每一個桶只需要一次 Fenwick 查詢
+    uint64_t remaining = prefix(index->all, LEADERBOARD_BUCKETS - 1);
+    while (out.size() < k && remaining > 0)
+    {
+        int bucket = findBucket(index->all, remaining);
+        collect(bucket, k - out.size(), out);
+        remaining -= bucketCount(index->all, bucket);
+    }
+}
+
+bool Leaderboard::percentileOf(int level, double p, int& score) const
+{
+    const uint32_t* counts = tree(level);
+    uint64_t runs = prefix(counts, LEADERBOARD_BUCKETS - 1);
+    if (runs == 0)
+    {
+        return false;
+    }
+
+    // nearest-rank：由低到高第 ceil(p × 局數) 局
+    uint64_t position = static_cast<uint64_t>(std::ceil(p * static_cast<double>(runs)));
+    position = std::min(std::max<uint64_t>(position, 1), runs);
+    int bucket = findBucket(counts, position);
+    uint64_t below = bucket > 0 ? prefix(counts, bucket - 1) : 0;
+    score = scoreAt(bucket, level, position - below);
+    return true;
+}
+
+bool Leaderboard::percentile(int level, double p, int& score)
+{
+    if (!mapping)
+    {
+        return false;
+    }
+    FileLock lock(fd, LOCK_SH);
+    return refresh() && percentileOf(level, p, score);
+}
+
+void Leaderboard::summarize(std::vector<LeaderboardSummary>& out)
+{
+    out.clear();
+    if (!mapping)
+    {
+        return;
+    }
+    FileLock lock(fd, LOCK_SH);
+    if (!refresh())
+    {
+        return;
+    }
+
+    for (int level = 0; level <= LEADERBOARD_LEVELS; ++level)
+    {
+        LeaderboardSummary summary;
+        summary.level = level;
+        summary.runs = prefix(tree(level), LEADERBOARD_BUCKETS - 1);
+        if (summary.runs == 0)
+        {
+            continue;
+        }
+        percentileOf(level, 0.50, summary.p50);
+        percentileOf(level, 0.90, summary.p90);
+        percentileOf(level, 0.99, summary.p99);
+        percentileOf(level, 1.0, summary.best);
+        out.push_back(summary);
+    }
+}
+
+std::string defaultLeaderboardPath(int boardWidth, int boardHeight)
+{
+    std::string path = DEFAULT_LEADERBOARD_PATH;
+    std::string suffix;
+    if (boardWidth != 10 || boardHeight != 20)
+    {
+        suffix += "-" + std::to_string(boardWidth) + "x" + std::to_string(boardHeight);
+    }
+    #ifdef TEST_MODE
+    suffix += "-test";
+    #endif
+    return path.insert(path.rfind('.'), suffix);
+}
+
+LeaderboardRecord makeLeaderboardRecord(int score, int lines, int level, unsigned long long ticks, uint64_t seed,
+                                        RandomizerMode mode, RunSource source)
+{
+    LeaderboardRecord record;
+    std::memset(static_cast<void*>(&record), 0, sizeof(record));
+    record.timestamp = static_cast<int64_t>(std::time(nullptr));
+    record.seed = seed;
+    record.durationMs = ticks * SimulatorBase::TICK_MS;
+    record.score = score;
+    record.lines = lines;
+    record.level = static_cast<int16_t>(level);
+    record.randomizer = static_cast<uint8_t>(mode);
+    record.source = static_cast<uint8_t>(source);
+    return record;
+}
+
+int runLeaderboard(const std::string& path, int count)
+{
+    Leaderboard leaderboard;
+    std::string error;
+
+    // 只讀取：不指定棋盤尺寸，也不建立新檔案
+    struct stat info;
+    if (stat(path.c_str(), &info) == -1)
+    {
+        std::cout << "[Leaderboard] " << path << " 還沒有記錄\n";
+        return 0;
+    }
+    if (!leaderboard.open(path, 0, 0, error))
+    {
+        std::cerr << "[Leaderboard] " << error << "\n";
+        return 1;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t runs = leaderboard.size();
+    std::vector<LeaderboardRecord> best;
+    leaderboard.top(static_cast<size_t>(std::max(count, 0)), best);
+    std::vector<LeaderboardSummary> summaries;
+    leaderboard.summarize(summaries);
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+    std::printf("[Leaderboard] %s (%dx%d)：共 %llu 局\n\n", path.c_str(), leaderboard.getBoardWidth(),
+                leaderboard.getBoardHeight(), static_cast<unsigned long long>(runs));
+
+    // printf 以位元組計算寬度：兩個中文字佔 6 個位元組、4 欄，欄寬要多算 2
+    std::printf("%6s %10s %8s %6s %10s %-10s %-9s %22s  %s\n", "名次", "分數", "行數", "關卡", "時間", "來源", "規則", "種子", "日期");
+    for (size_t i = 0; i < best.size(); ++i)
+    {
+        const LeaderboardRecord& record = best[i];
+        char date[32] = "";
+        time_t timestamp = static_cast<time_t>(record.timestamp);
+        struct tm local;
+        if (localtime_r(&timestamp, &local))
+        {
+            std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M", &local);
+        }
+        unsigned long long seconds = record.durationMs / 1000;
+        std::printf("%4zu %8d %6d %4d %5llu:%02llu %-8s %-7s %20llu  %s\n", i + 1, record.score, record.lines, record.level,
+                    seconds / 60, seconds % 60, runSourceName(static_cast<RunSource>(record.source)),
+                    randomizerModeName(static_cast<RandomizerMode>(record.randomizer)),
+                    static_cast<unsigned long long>(record.seed), date);
+    }
+
+    std::printf("\n%-12s %12s %8s %8s %8s %10s\n", "結束關卡", "局數", "p50", "p90", "p99", "最高");
+    for (size_t i = 0; i < summaries.size(); ++i)
+    {
+        const LeaderboardSummary& summary = summaries[i];
+        char label[16];
+        int width = 10;
+        if (summary.level == 0)
+        {
+            std::snprintf(label, sizeof(label), "全部");
+        }
+        else if (summary.level == LEADERBOARD_LEVELS)
+        {
+            std::snprintf(label, sizeof(label), "完成");
+        }
+        else
+        {
+            std::snprintf(label, sizeof(label), "%d", summary.level);
+            width = 8;
+        }
+        std::printf("%-*s %12llu %8d %8d %8d %8d\n", width, label, static_cast<unsigned long long>(summary.runs),
+                    summary.p50, summary.p90, summary.p99, summary.best);
+    }
+
+    std::printf("\n查詢耗時 %.1f us\n", micros);
+    return 0;
+}
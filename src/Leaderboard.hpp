@@ -0,0 +1,168 @@
+#ifndef LEADERBOARD
+#define LEADERBOARD
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Simulator.hpp"
+
+#define DEFAULT_LEADERBOARD_PATH "./oblivionis.scores"
+
+// 成績記錄 = 64 位元組檔頭 + 固定大小的索引 + 只會附加的記錄，整個檔案以 mmap 對映。
+// 分數以 100 分 (消一行的分數) 為一個桶，索引是各桶局數的 Fenwick tree (全部一棵、每個結束關卡各一棵)
+// 與每個桶的記錄串列：名次、前 K 名與百分位數都只需 O(log 桶數) 次查表，與記錄數無關。
+// 分數不落在桶的整數倍上的記錄另外串成一條，查詢時逐筆比較 (目前的計分方式不會產生這種記錄)。
+// 多個行程 (遊戲、headless) 可以同時寫入同一個檔案：附加時持有 flock 排他鎖，查詢時持有共享鎖。
+// 更新索引前先標記 dirty，寫到一半當掉時下次開檔會從記錄重建索引
+
+static const uint16_t LEADERBOARD_VERSION = 1;
+
+static const int LEADERBOARD_BUCKET_WIDTH = 100;         // 每個分數桶涵蓋的分數
+static const int LEADERBOARD_BUCKETS = 16384;            // 2 的冪次；最高的桶收容所有更高的分數
+static const int LEADERBOARD_LEVELS = SimulatorBase::MAX_LEVEL + 1;   // 結束關卡 1 ~ MAX_LEVEL + 1 (完成所有關卡)
+
+// 這一局由誰玩
+enum class RunSource : uint8_t
+{
+    Human, Bot, Versus, Headless
+};
+
+const char* runSourceName(RunSource source);
+
+struct LeaderboardRecord
+{
+    int64_t timestamp;      // 結束時間 (Unix 秒)
+    uint64_t seed;
+    uint64_t durationMs;    // 遊戲時間 (tick 數 × TICK_MS，不含倒數與暫停)
+    int32_t score;
+    int32_t lines;
+    int16_t level;          // 結束時的關卡；MAX_LEVEL + 1 表示完成所有關卡
+    uint8_t randomizer;     // RandomizerMode
+    uint8_t source;         // RunSource
+    uint32_t next;          // 同一條串列中前一筆記錄的編號 + 1 (0 表示沒有)，由 Leaderboard 維護
+};
+
+struct LeaderboardHeader
+{
+    char magic[4];          // "OBLB"
+    uint16_t version;
+    uint8_t flags;          // BUILD_FLAGS (FileFormat.hpp)
+    uint8_t dirty;          // 索引更新中；開檔時為 1 表示上次寫到一半，從記錄重建索引
+    uint16_t boardWidth;    // 不同尺寸的棋盤分數不能比較，各自一個檔案
+    uint16_t boardHeight;
+    uint32_t recordSize;    // sizeof(LeaderboardRecord)
+    uint32_t bucketWidth;
+    uint32_t buckets;
+    uint32_t levels;
+    uint32_t indexSize;     // sizeof(LeaderboardIndex)
+    uint64_t count;         // 已寫入的記錄數
+    uint64_t capacity;      // 檔案目前容納的記錄數 (用完時加倍)
+    uint8_t reserved2[16];
+};
+
+struct LeaderboardIndex
+{
+    uint32_t all[LEADERBOARD_BUCKETS];                          // Fenwick tree：各分數桶的局數
+    uint32_t byLevel[LEADERBOARD_LEVELS][LEADERBOARD_BUCKETS];  // 依結束關卡分開的 Fenwick tree
+    uint32_t head[LEADERBOARD_BUCKETS];                         // 分數剛好是 桶 × 100 的最新一筆記錄編號 + 1
+    uint32_t offGrid[LEADERBOARD_BUCKETS];                      // 其他分數 (不是 100 的倍數或超出最高桶) 的最新一筆
+};
+
+// 各結束關卡的分數分布 (level 0 為全部)
+struct LeaderboardSummary
+{
+    int level;
+    uint64_t runs;
+    int p50;
+    int p90;
+    int p99;
+    int best;
+};
+
+class Leaderboard
+{
+    private:
+        int fd;
+        std::string path;
+        void* mapping;
+        size_t mappedSize;
+        LeaderboardHeader* header;
+        LeaderboardIndex* index;
+        LeaderboardRecord* records;
+
+        bool initialize(int boardWidth, int boardHeight, std::string& error);
+        bool map(size_t size, std::string& error);
+        void unmap();
+
+        // 其他行程擴充了檔案時重新對映 (持有鎖時呼叫)
+        bool refresh();
+
+        // 把第 id 筆記錄加進索引
+        void insert(uint32_t id);
+        void rebuild();
+
+        const uint32_t* tree(int level) const;
+        static uint64_t prefix(const uint32_t* tree, int bucket);
+        static uint64_t bucketCount(const uint32_t* tree, int bucket);
+        static int findBucket(const uint32_t* tree, uint64_t position);
+
+        // 第 bucket 桶中結束於 level (0 為全部) 的零散記錄
+        void offGrid(int bucket, int level, std::vector<LeaderboardRecord>& out) const;
+
+        // 依分數由高到低取出第 bucket 桶的記錄 (同分時較新的在前)，最多 limit 筆
+        void collect(int bucket, size_t limit, std::vector<LeaderboardRecord>& out) const;
+
+        // 第 bucket 桶中結束於 level 的記錄裡，由低到高第 position 個分數 (position 從 1 開始)
+        int scoreAt(int bucket, int level, uint64_t position) const;
+
+        // percentile() 不取鎖的版本
+        bool percentileOf(int level, double p, int& score) const;
+
+    public:
+        Leaderboard();
+        ~Leaderboard();
+
+        Leaderboard(const Leaderboard&) = delete;
+        Leaderboard& operator=(const Leaderboard&) = delete;
+
+        // 開啟或建立成績記錄；格式、建置模式或棋盤尺寸不符時回傳 false (不會清空檔案)。
+        // 棋盤尺寸為 0 時接受任何尺寸，但不會建立新檔案 (只查詢時使用)
+        bool open(const std::string& path, int boardWidth, int boardHeight, std::string& error);
+        void close();
+
+        bool isOpen() const;
+        int getBoardWidth() const;
+        int getBoardHeight() const;
+
+        // 附加一局的結果 (record.next 會被覆寫)
+        bool append(const LeaderboardRecord& record, std::string& error);
+
+        // 記錄的局數
+        uint64_t size();
+
+        // score 的名次：分數比它高的局數 + 1
+        uint64_t rank(int score);
+
+        // 分數最高的 k 局 (同分時較新的在前)
+        void top(size_t k, std::vector<LeaderboardRecord>& out);
+
+        // 結束於 level 的局中 (0 為全部)，p 百分位的分數 (p 介於 0 ~ 1)；沒有記錄時回傳 false
+        bool percentile(int level, double p, int& score);
+
+        // 全部與每個結束關卡的分數分布，略過沒有記錄的關卡
+        void summarize(std::vector<LeaderboardSummary>& out);
+};
+
+// 預設的記錄檔：10x20 為 DEFAULT_LEADERBOARD_PATH，其他尺寸與測試模式在檔名加上後綴
+std::string defaultLeaderboardPath(int boardWidth, int boardHeight);
+
+// 一局結束時的記錄 (時間戳記為現在)
+LeaderboardRecord makeLeaderboardRecord(int score, int lines, int level, unsigned long long ticks, uint64_t seed,
+                                        RandomizerMode mode, RunSource source);
+
+// --leaderboard：印出前 count 名與各關卡的分數分布
+int runLeaderboard(const std::string& path, int count);
+
+#endif
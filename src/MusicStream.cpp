@@ -0,0 +1,235 @@
+#include "MusicStream.hpp"
+#include "AudioMixer.hpp"
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#ifdef OBLIVIONIS_MPG123
+    #include <mpg123.h>
+    #include <mutex>
+#endif
+
+MusicStream::MusicStream()
+: ring(BUFFER_FRAMES * MIXER_CHANNELS),
+  running(false),
+  child(-1)
+{}
+
+MusicStream::~MusicStream() 
+{
+    stop();
+}
+
+bool MusicStream::open(const std::string& filePath) 
+{
+    stop();
+
+    path = filePath;
+    running = true;
+    decoder = std::thread(&MusicStream::decodeLoop, this);
+    return true;
+}
+
+void MusicStream::stop() 
+{
+    running = false;
+
+    // 只終止自己啟動的子行程，讓阻塞中的 read() 返回
+    pid_t pid = child.load();
+    if (pid > 0) 
+    {
+        kill(pid, SIGTERM);
+    }
+
+    if (decoder.joinable()) 
+    {
+        decoder.join();
+    }
+
+    // 此時解碼執行緒已結束，混音器也不再讀取，可以安全清空
+    ring.clear();
+}
+
+size_t MusicStream::read(int16_t* samples, size_t frames) 
+{
+    return ring.read(samples, frames * MIXER_CHANNELS) / MIXER_CHANNELS;
+}
+
+size_t MusicStream::bufferedFrames() const 
+{
+    return ring.size() / MIXER_CHANNELS;
+}
+
+const std::string& MusicStream::getPath() const 
+{
+    return path;
+}
+
+bool MusicStream::pushSamples(const int16_t* samples, size_t count) 
+{
+    while (count > 0) 
+    {
+        size_t written = ring.write(samples, count);
+        samples += written;
+        count -= written;
+
+        if (count > 0) 
+        {
+            if (!running) 
+            {
+                return false;
+            }
+            // 緩衝已滿 (領先播放 1 秒)：等混音器消化一些
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+    return running;
+}
+
+void MusicStream::decodeLoop() 
+{
+    // 每播完一輪就從頭再解一次；緩衝裡還有 1 秒的 PCM，重新開檔的時間不會造成空白
+    while (running) 
+    {
+#ifdef OBLIVIONIS_MPG123
+        bool ok = decodeWithLibrary();
+#else
+        bool ok = decodeWithProcess();
+#endif
+        if (!ok) 
+        {
+            // 無法解碼 (檔案不存在、沒有 mpg123 等)：不要一直重試
+            break;
+        }
+    }
+}
+
+#ifdef OBLIVIONIS_MPG123
+
+bool MusicStream::decodeWithLibrary() 
+{
+    static std::once_flag initOnce;
+    std::call_once(initOnce, []() { mpg123_init(); });
+
+    int error = MPG123_OK;
+    mpg123_handle* handle = mpg123_new(nullptr, &error);
+    if (!handle) 
+    {
+        return false;
+    }
+
+    // 強制輸出混音器格式：48 kHz、雙聲道、16-bit
+    mpg123_param(handle, MPG123_FORCE_RATE, MIXER_RATE, 0);
+    mpg123_param(handle, MPG123_FLAGS, MPG123_FORCE_STEREO | MPG123_QUIET, 0);
+    mpg123_format_none(handle);
+    mpg123_format(handle, MIXER_RATE, MPG123_STEREO, MPG123_ENC_SIGNED_16);
+
+    if (mpg123_open(handle, path.c_str()) != MPG123_OK) 
+    {
+        std::cerr << "[Error] 無法開啟 BGM: " << path << "\n";
+        mpg123_delete(handle);
+        return false;
+    }
+
+    int16_t buffer[4096];
+    bool produced = false;
+    while (running) 
+    {
+        size_t bytes = 0;
+        int result = mpg123_read(handle, reinterpret_cast<unsigned char*>(buffer), sizeof(buffer), &bytes);
+        if (bytes > 0) 
+        {
+            produced = true;
+            if (!pushSamples(buffer, bytes / sizeof(int16_t))) 
+            {
+                break;
+            }
+        }
+        if (result == MPG123_DONE || (result != MPG123_OK && result != MPG123_NEW_FORMAT)) 
+        {
+            break;
+        }
+    }
+
+    mpg123_close(handle);
+    mpg123_delete(handle);
+    return produced;
+}
+
+#else
+
+bool MusicStream::decodeWithProcess() 
+{
+    int fds[2];
+    if (pipe(fds) == -1) 
+    {
+        return false;
+    }
+
+    pid_t pid = fork();
+    if (pid == -1) 
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (pid == 0) 
+    {
+        // 子行程：PCM 輸出到管線，錯誤訊息丟掉以免弄亂畫面
+        dup2(fds[1], STDOUT_FILENO);
+        int devNull = ::open("/dev/null", O_WRONLY);
+        if (devNull != -1) 
+        {
+            dup2(devNull, STDERR_FILENO);
+        }
+        close(fds[0]);
+        close(fds[1]);
+        execlp("mpg123", "mpg123", "-q", "-s", "-r", "48000", "--stereo", "-e", "s16", path.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+
+    close(fds[1]);
+    child = pid;
+
+    // 位元組不一定剛好落在樣本邊界，多出來的留到下一次
+    alignas(int16_t) char buffer[8192];
+    size_t carry = 0;
+    bool produced = false;
+
+    while (running) 
+    {
+        ssize_t n = ::read(fds[0], buffer + carry, sizeof(buffer) - carry);
+        if (n <= 0) 
+        {
+            break;
+        }
+
+        size_t total = carry + static_cast<size_t>(n);
+        size_t usable = total - total % (sizeof(int16_t) * MIXER_CHANNELS);
+        if (usable > 0) 
+        {
+            produced = true;
+            if (!pushSamples(reinterpret_cast<const int16_t*>(buffer), usable / sizeof(int16_t))) 
+            {
+                break;
+            }
+        }
+        carry = total - usable;
+        for (size_t i = 0; i < carry; ++i) 
+        {
+            buffer[i] = buffer[usable + i];
+        }
+    }
+
+    child = -1;
+    close(fds[0]);
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    return produced;
+}
+
+#endif
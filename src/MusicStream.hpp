@@ -0,0 +1,60 @@
+#ifndef MUSICSTREAM
+#define MUSICSTREAM
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <sys/types.h>   // for pid_t
+#include "RingBuffer.hpp"
+
+// 串流式 BGM：解碼執行緒把 MP3 解成混音器格式的 PCM，推進固定大小的環狀緩衝，
+// 混音器再從緩衝取用。不論曲子多長，記憶體都只有這一個緩衝；播完自動從頭無縫循環。
+//
+// 預設在程式內用 libmpg123 解碼 (Makefile 偵測到函式庫時定義 OBLIVIONIS_MPG123)；
+// 沒有函式庫時才退回備援：啟動一個只屬於本串流的 mpg123 子行程把 PCM 輸出到管線 (停止時只終止這個子行程)
+class MusicStream 
+{
+    public:
+        static const size_t BUFFER_FRAMES = 48000;   // 緩衝 1 秒的 PCM
+
+    private:
+        RingBuffer<int16_t> ring;
+        std::string path;
+        std::thread decoder;
+        std::atomic<bool> running;
+        std::atomic<pid_t> child;     // 備援模式的 mpg123 子行程 (-1 表示沒有)
+
+        void decodeLoop();
+
+        // 把 PCM 推進緩衝，滿了就等混音器消化；停止時回傳 false
+        bool pushSamples(const int16_t* samples, size_t count);
+
+#ifdef OBLIVIONIS_MPG123
+        bool decodeWithLibrary();
+#else
+        bool decodeWithProcess();
+#endif
+
+    public:
+        MusicStream();
+        ~MusicStream();
+
+        // 開始 (預先) 解碼指定檔案。呼叫前混音器必須已不再讀取此串流
+        bool open(const std::string& path);
+
+        // 停止解碼並清空緩衝
+        void stop();
+
+        // 混音器：讀出最多 frames 個 frame，回傳實際讀出數 (不足表示解碼跟不上)
+        size_t read(int16_t* samples, size_t frames);
+
+        // 已預先解碼好的 frame 數
+        size_t bufferedFrames() const;
+
+        const std::string& getPath() const;
+};
+
+#endif
@@ -0,0 +1,117 @@
+#include "Randomizer.hpp"
+#include <cstring>
+
+Randomizer::Randomizer(uint64_t seed, RandomizerMode mode)
+: rng(seed),
+  mode(mode),
+  bagIndex(7)
+{
+    // 一開始的歷史放 S、Z，第一個方塊比較不會是難接的 S/Z
+    for (int i = 0; i < HISTORY_SIZE; ++i) 
+    {
+        history[i] = i % 2 ? TetrominoType::S : TetrominoType::Z;
+    }
+}
+
+void Randomizer::refillBag() 
+{
+    for (int i = 0; i < 7; ++i) 
+    {
+        bag[i] = static_cast<TetrominoType>(i);
+    }
+
+    // Fisher-Yates 洗牌
+    for (int i = 6; i > 0; --i) 
+    {
+        int j = static_cast<int>(rng.nextBelow(i + 1));
+        TetrominoType t = bag[i];
+        bag[i] = bag[j];
+        bag[j] = t;
+    }
+    bagIndex = 0;
+}
+
+TetrominoType Randomizer::nextType() 
+{
+    switch (mode) 
+    {
+        case RandomizerMode::Bag7:
+        {
+            if (bagIndex == 7) 
+            {
+                refillBag();
+            }
+            return bag[bagIndex++];
+        }
+
+        case RandomizerMode::History:
+        {
+            TetrominoType type = static_cast<TetrominoType>(rng.nextBelow(7));
+            for (int roll = 1; roll < HISTORY_ROLLS; ++roll) 
+            {
+                bool repeated = false;
+                for (int i = 0; i < HISTORY_SIZE; ++i) 
+                {
+                    repeated = repeated || history[i] == type;
+                }
+                if (!repeated) 
+                {
+                    break;
+                }
+                type = static_cast<TetrominoType>(rng.nextBelow(7));
+            }
+
+            for (int i = HISTORY_SIZE - 1; i > 0; --i) 
+            {
+                history[i] = history[i - 1];
+            }
+            history[0] = type;
+            return type;
+        }
+
+        case RandomizerMode::Random:
+        default:
+            return static_cast<TetrominoType>(rng.nextBelow(7));
+    }
+}
+
+int Randomizer::nextColor() 
+{
+    return static_cast<int>(rng.nextBelow(7)) + 1;
+}
+
+RandomizerMode Randomizer::getMode() const 
+{
+    return mode;
+}
+
+bool parseRandomizerMode(const char* name, RandomizerMode& mode) 
+{
+    if (std::strcmp(name, "random") == 0) 
+    {
+        mode = RandomizerMode::Random;
+    }
+    else if (std::strcmp(name, "bag") == 0) 
+    {
+        mode = RandomizerMode::Bag7;
+    }
+    else if (std::strcmp(name, "history") == 0) 
+    {
+        mode = RandomizerMode::History;
+    }
+    else 
+    {
+        return false;
+    }
+    return true;
+}
+
+const char* randomizerModeName(RandomizerMode mode) 
+{
+    switch (mode) 
+    {
+        case RandomizerMode::Bag7:    return "bag";
+        case RandomizerMode::History: return "history";
+        default:                      return "random";
+    }
+}
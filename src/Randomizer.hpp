@@ -0,0 +1,52 @@
+#ifndef RANDOMIZER
+#define RANDOMIZER
+
+#pragma once
+
+#include <cstdint>
+#include "Tetromino.hpp"
+#include "Xoshiro.hpp"
+
+// 決定下一個方塊的規則
+enum class RandomizerMode 
+{
+    Random,    // 每次獨立均勻抽取 (原本的行為)
+    Bag7,      // 七種方塊洗牌成一袋，抽完再洗下一袋
+    History    // 記住最近 4 個方塊，抽到重複的就重抽 (最多 6 次)
+};
+
+// 每局一份的方塊產生器，由種子與模式完全決定整局的方塊與顏色序列
+class Randomizer 
+{
+    public:
+        static const int HISTORY_SIZE = 4;
+        static const int HISTORY_ROLLS = 6;
+
+    private:
+        Xoshiro256 rng;
+        RandomizerMode mode;
+
+        TetrominoType bag[7];
+        int bagIndex;                          // 下一個要從袋子取出的位置，7 表示需要重洗
+
+        TetrominoType history[HISTORY_SIZE];   // 最近出現的方塊 (history[0] 為最新)
+
+        void refillBag();
+
+    public:
+        explicit Randomizer(uint64_t seed = 0, RandomizerMode mode = RandomizerMode::Random);
+
+        // 下一個方塊的形狀
+        TetrominoType nextType();
+
+        // 下一個方塊的顏色 (1~7)
+        int nextColor();
+
+        RandomizerMode getMode() const;
+};
+
+// 命令列用的模式名稱："random"、"bag"、"history"
+bool parseRandomizerMode(const char* name, RandomizerMode& mode);
+const char* randomizerModeName(RandomizerMode mode);
+
+#endif
@@ -0,0 +1,123 @@
+#include "RenderThread.hpp"
+#include <chrono>
+
+RenderThread::RenderThread(int fps)
+: running(false),
+  invalidateRequested(false),
+  maxFps(fps),
+  boardOffset(Renderer::DEFAULT_BOARD_OFFSET),
+  published(0),
+  drawn(0)
+{}
+
+RenderThread::~RenderThread() 
+{
+    stop();
+}
+
+void RenderThread::start() 
+{
+    if (worker.joinable()) 
+    {
+        return;
+    }
+
+    running = true;
+    worker = std::thread(&RenderThread::loop, this);
+}
+
+void RenderThread::stop() 
+{
+    running = false;
+    if (worker.joinable()) 
+    {
+        worker.join();
+    }
+}
+
+FrameSnapshot& RenderThread::beginFrame() 
+{
+    return frames.writeBuffer();
+}
+
+void RenderThread::publish() 
+{
+    frames.publish();
+    published++;
+}
+
+void RenderThread::invalidate() 
+{
+    invalidateRequested = true;
+}
+
+void RenderThread::setMaxFps(int fps) 
+{
+    maxFps = fps > 0 ? fps : 1;
+}
+
+void RenderThread::setBoardOffset(int offset) 
+{
+    boardOffset = offset;
+}
+
+unsigned long RenderThread::getPublishedFrames() const 
+{
+    return published;
+}
+
+unsigned long RenderThread::getDrawnFrames() const 
+{
+    return drawn;
+}
+
+const LatencyHistogram& RenderThread::getDrawTimes() const 
+{
+    return drawTimes;
+}
+
+void RenderThread::loop() 
+{
+    auto nextFrame = std::chrono::steady_clock::now();
+
+    while (true) 
+    {
+        // 停止前再畫一次，確保最後的狀態有顯示出來
+        bool stopping = !running;
+
+        if (invalidateRequested.exchange(false)) 
+        {
+            renderer.invalidate();
+        }
+
+        if (frames.update()) 
+        {
+            const FrameSnapshot& snapshot = frames.readBuffer();
+            if (snapshot.showTimings) 
+            {
+                renderer.setDrawTiming(drawTimes.summary());
+            }
+            renderer.setBoardOffset(boardOffset);
+
+            auto begin = std::chrono::steady_clock::now();
+            renderer.draw(snapshot);
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+            drawTimes.record(static_cast<uint64_t>(ns));
+            drawn++;
+        }
+
+        if (stopping) 
+        {
+            break;
+        }
+
+        // 以固定頻率取最新的快照，中間被覆蓋的快照就此略過
+        nextFrame += std::chrono::microseconds(1000000 / maxFps);
+        auto now = std::chrono::steady_clock::now();
+        if (nextFrame < now) 
+        {
+            nextFrame = now;
+        }
+        std::this_thread::sleep_until(nextFrame);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef RENDERTHREAD
+#define RENDERTHREAD
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include "Renderer.hpp"
+#include "TripleBuffer.hpp"
+
+// 專用的繪製執行緒：遊戲執行緒只負責發佈快照，
+// 終端機寫得再慢也不會拖住輸入與重力；跟不上的幀直接略過
+class RenderThread 
+{
+    private:
+        Renderer renderer;
+        TripleBuffer<FrameSnapshot> frames;
+        std::thread worker;
+        std::atomic<bool> running;
+        std::atomic<bool> invalidateRequested;
+
+        std::atomic<int> maxFps;                 // 繪製頻率上限
+        std::atomic<int> boardOffset;            // 盤面的水平縮排 (繪製執行緒在下一幀套用)
+        std::atomic<unsigned long> published;    // 遊戲執行緒發佈的快照數
+        std::atomic<unsigned long> drawn;        // 實際畫出的幀數
+        LatencyHistogram drawTimes;              // 每幀 Renderer::draw 的耗時，只由繪製執行緒寫入
+
+        void loop();
+
+    public:
+        explicit RenderThread(int maxFps = 60);
+        ~RenderThread();
+
+        // 啟動 / 停止繪製執行緒 (stop 會等最後一幀畫完)
+        void start();
+        void stop();
+
+        // 遊戲執行緒：取得可寫入的快照，填好後呼叫 publish()
+        FrameSnapshot& beginFrame();
+        void publish();
+
+        // 要求下一幀完整重繪
+        void invalidate();
+
+        // 畫面設定 (可在執行中更改)
+        void setMaxFps(int fps);
+        void setBoardOffset(int offset);
+
+        unsigned long getPublishedFrames() const;
+        unsigned long getDrawnFrames() const;
+
+        // stop() 之後才能讀取
+        const LatencyHistogram& getDrawTimes() const;
+};
+
+#endif
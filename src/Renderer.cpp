@@ -1,6 +1,9 @@
 #include "Renderer.hpp"
 #include <iostream>
-#include <cstdlib>  // for system("clear") / system("cls")
+#include <cstdio>
+#include <cstring>
+#include <errno.h>    // for EINTR, EAGAIN
+#include <poll.h>     // for poll()
 
 static const char* COLOR_CODES[] = 
 {
@@ -16,44 +19,237 @@ static const char* COLOR_CODES[] =
 
 #define RESET "\033[0m"
 
+// 同步輸出 (synchronized output)：終端機收齊整幀後才一次更新，避免閃爍
+#define SYNC_BEGIN "\033[?2026h"
+#define SYNC_END   "\033[?2026l"
+
+// 方塊格在 Cell 中的標記，輸出時換成 "█"
+static const char BLOCK_GLYPH = '\x01';
+
+// 影子方塊格的標記，輸出時換成 "░"
+static const char GHOST_GLYPH = '\x02';
+
+// displayGrid 中影子方塊所在的格子 (一般格子是顏色編號 0~7)
+static const int GHOST_CELL = -1;
+
+// 無效字元：invalidate() 後 front 會填滿它，保證每一格都被視為有變動
+static const char INVALID_GLYPH = '\0';
+
+// 關卡框的內部寬度
+static const int LEVEL_BOX_WIDTH = 20;
+
 // 將 color 限制在 1~7，超出以取模對應
-inline const char* getColorCode(int color) 
+inline int clampColor(int color) 
 {
     if (color <= 0) 
-        return RESET; 
+        return 0; 
     int idx = color % 8; 
 
     if (idx == 0) 
         idx = 1;
     
-    return COLOR_CODES[idx];
+    return idx;
 }
 
-Renderer::Renderer() {}
+Renderer::Renderer(int outputFd)
+: fd(outputFd),
+  valid(false),
+  lastFrameBytes(0),
+  drawTiming(),
+  boardOffset(DEFAULT_BOARD_OFFSET),
+  boardBorder("+" + std::string(Board::WIDTH * 2, '-') + "+"),
+  levelBorder("+" + std::string(LEVEL_BOX_WIDTH, '-') + "+")
+{
+    // 最壞情況：每格都要游標定位 + 顏色 + 3 bytes 的 UTF-8 字元
+    frame.reserve(SCREEN_ROWS * SCREEN_COLS * 16 + 64);
+    // 狀態列只會是較短的倒數訊息，預先配置後每幀的 assign 都不會再配置
+    status.reserve(SCREEN_COLS * 2);
+    shownStatus.reserve(SCREEN_COLS * 2);
+    invalidate();
+}
 
 Renderer::~Renderer() {}
 
-void Renderer::draw(const Board& board, const Tetromino& tetromino, const ScoreManager& scoreManager, int level)
+void Renderer::invalidate() 
+{
+    valid = false;
+    shownStatus.clear();
+    for (int r = 0; r < SCREEN_ROWS; ++r) 
+    {
+        for (int c = 0; c < SCREEN_COLS; ++c) 
+        {
+            front[r][c].glyph = INVALID_GLYPH;
+            front[r][c].color = 0;
+        }
+    }
+}
+
+size_t Renderer::getLastFrameBytes() const 
 {
-    #ifdef _WIN32
-        system("cls");
-    #else
-        system("clear");
-    #endif
+    return lastFrameBytes;
+}
 
-    // 你想要的水平縮排量（可自行調整）
-    const int offset = 20;  
+void Renderer::setDrawTiming(const PhaseTiming& timing) 
+{
+    drawTiming = timing;
+}
 
+void Renderer::setBoardOffset(int offset) 
+{
+    boardOffset = offset;
+}
+
+void Renderer::put(int row, int col, char glyph, int color) 
+{
+    if (row < 0 || row >= SCREEN_ROWS || col < 0 || col >= SCREEN_COLS) 
+    {
+        return;
+    }
+    back[row][col].glyph = glyph;
+    back[row][col].color = static_cast<uint8_t>(color);
+}
+
+void Renderer::putText(int row, int col, const char* text, size_t length) 
+{
+    for (size_t i = 0; i < length; ++i) 
+    {
+        put(row, col + static_cast<int>(i), text[i], 0);
+    }
+}
+
+void Renderer::putText(int row, int col, const char* text) 
+{
+    putText(row, col, text, std::strlen(text));
+}
+
+void Renderer::putText(int row, int col, const std::string& text) 
+{
+    putText(row, col, text.data(), text.size());
+}
+
+void Renderer::draw(const FrameSnapshot& snapshot)
+{
+    compose(snapshot);
+    flush();
+}
+
+void Renderer::compose(const FrameSnapshot& snapshot) 
+{
+    const Board& board = snapshot.board;
+    const Tetromino& tetromino = snapshot.tetromino;
+    const ScoreManager& scoreManager = snapshot.scoreManager;
+    int level = snapshot.level;
+
+    // 整個 back 緩衝先清成空白
+    for (int r = 0; r < SCREEN_ROWS; ++r) 
+    {
+        for (int c = 0; c < SCREEN_COLS; ++c) 
+        {
+            back[r][c].glyph = ' ';
+            back[r][c].color = 0;
+        }
+    }
+
+    // 水平縮排量 (設定檔的 RENDER_OFFSET)
+    const int offset = boardOffset;
+    // 邊框 '+' / '|' 所在的欄位 (縮排後再空兩格)
+    const int left = offset + 2;
+
+    // 棋盤顯示寬度（不含邊框），一格要印 2 字元，所以是 WIDTH * 2
+    const int boardContentWidth = Board::WIDTH * 2;
+
+    // 文字都格式化到堆疊上的緩衝，每幀不配置記憶體
+    char text[96];
+
+    // 計算 Level 佔的字元數，置中對齊
+    int length = std::snprintf(text, sizeof(text), "Level: %d", level);
+    int leftPadding = (LEVEL_BOX_WIDTH - length) / 2;
+
+    putText(0, left, levelBorder);
+    putText(1, left, "|");
+    putText(1, left + 1 + leftPadding, text, length);
+    putText(1, left + 1 + LEVEL_BOX_WIDTH, "|");
+    putText(2, left, levelBorder);
+
+    // (1) 在遊戲盤面上方顯示分數，並用邊框框起來
+    putText(3, left, boardBorder);
+    length = std::snprintf(text, sizeof(text), "| Score: %d", scoreManager.getScore());
+    putText(4, left, text, length);
+    putText(4, left + 1 + boardContentWidth, "|");
+    putText(5, left, boardBorder);
+
+    // 計時面板放在分數框右側
+    if (snapshot.showTimings) 
+    {
+        composeTimings(snapshot, 3, left + boardContentWidth + 4);
+    }
+
+    // (2) 遊戲盤面
+    const int boardTop = 6;
+    composeBoard(board, tetromino, boardTop, left);
+
+    // (3) 對戰：對手的關卡、分數與盤面放在右側
+    if (snapshot.versus) 
+    {
+        const int opponentLeft = left + boardContentWidth + 4;
+        length = std::snprintf(text, sizeof(text), "Opponent  Level: %d", snapshot.opponentLevel);
+        putText(1, opponentLeft + 1, text, length);
+        putText(3, opponentLeft, boardBorder);
+        length = std::snprintf(text, sizeof(text), "| Score: %d", snapshot.opponentScore);
+        putText(4, opponentLeft, text, length);
+        putText(4, opponentLeft + 1 + boardContentWidth, "|");
+        putText(5, opponentLeft, boardBorder);
+        composeBoard(snapshot.opponentBoard, snapshot.opponentTetromino, boardTop, opponentLeft);
+
+        composeGarbage(snapshot.pendingGarbage, boardTop, left - 1);
+        composeGarbage(snapshot.opponentPendingGarbage, boardTop, opponentLeft - 1);
+    }
+
+    // 控制提示 (不加入 offset)
+    putText(boardTop + 2 + Board::HEIGHT, 0, "Controls: [Left/Right=Move] [Up=Rotate] [Down=Drop] [Space=Hard drop] [x=Exit]");
+
+    // 狀態列：關卡開始前的倒數
+    status.clear();
+    if (snapshot.countdown > 0) 
+    {
+        length = std::snprintf(text, sizeof(text), "[Level %d] 即將開始... 倒數 %d 秒", level, snapshot.countdown);
+        status.assign(text, length);
+    }
+}
+
+void Renderer::composeBoard(const Board& board, const Tetromino& tetromino, int top, int left) 
+{
     // 取得棋盤狀態 (儲存顏色編號)
-    auto grid = board.getGrid();
-    // 暫時複製一份
-    auto displayGrid = grid;
+    int displayGrid[Board::HEIGHT][Board::WIDTH];
+    for (int r = 0; r < Board::HEIGHT; ++r) 
+    {
+        for (int c = 0; c < Board::WIDTH; ++c) 
+        {
+            displayGrid[r][c] = board.getCell(r, c);
+        }
+    }
 
     // 疊加正在操作的方塊
-    auto blocks = tetromino.getBlocks();
+    const auto& blocks = tetromino.getBlocks();
     auto pos = tetromino.getPosition();
     int activeColor = tetromino.getColor();
 
+    // 影子方塊：直接落下會停的位置 (天際線查表)，只畫在空格上，之後被正在操作的方塊蓋過
+    int ghostRow = board.getDropRow(tetromino);
+    if (ghostRow > pos.first) 
+    {
+        for (auto &block : blocks) 
+        {
+            int row = ghostRow + block.first;
+            int col = pos.second + block.second;
+
+            if (row >= 0 && row < Board::HEIGHT && col >= 0 && col < Board::WIDTH && displayGrid[row][col] == 0) 
+            {
+                displayGrid[row][col] = GHOST_CELL;
+            }
+        }
+    }
+
     for (auto &block : blocks) 
     {
         int row = pos.first + block.first;
@@ -65,105 +261,179 @@ void Renderer::draw(const Board& board, const Tetromino& tetromino, const ScoreM
         }
     }
 
-    // 顯示關卡
-    const int boxWidth = 20; // 設定「Level」框的內部寬度
+    // 棋盤顯示寬度（不含邊框），一格要印 2 字元，所以是 WIDTH * 2
+    const int boardContentWidth = Board::WIDTH * 2;
 
-    // 計算 Level 佔的字元數
-    std::string levelText = "Level: " + std::to_string(level);
-    int levelTextLength = levelText.length();
-    int padding = boxWidth - levelTextLength; // 算出剩餘空間
-    int leftPadding = padding / 2;  // 左邊空格
-    int rightPadding = padding - leftPadding;  // 右邊空格
+    putText(top, left, boardBorder);
 
-    // 打印上框
-    std::cout << std::string(offset, ' ') << "  +";
-    std::cout << std::string(boxWidth, '-') << "+\n";
-
-    // 打印 Level 內容，確保置中對齊
-    std::cout << std::string(offset, ' ') << "  |" 
-              << std::string(leftPadding, ' ') << levelText 
-              << std::string(rightPadding, ' ') << "|\n";
+    for (int r = 0; r < Board::HEIGHT; ++r) 
+    {
+        int screenRow = top + 1 + r;
+        put(screenRow, left, '|', 0);
+        for (int c = 0; c < Board::WIDTH; ++c) 
+        {
+            if (displayGrid[r][c] == GHOST_CELL) 
+            {
+                put(screenRow, left + 1 + c * 2, GHOST_GLYPH, clampColor(activeColor));
+                put(screenRow, left + 2 + c * 2, GHOST_GLYPH, clampColor(activeColor));
+                continue;
+            }
 
-    // 打印下框
-    std::cout << std::string(offset, ' ') << "  +";
-    std::cout << std::string(boxWidth, '-') << "+\n";
+            int cellColor = clampColor(displayGrid[r][c]);
+            if (cellColor != 0) 
+            {
+                // 以顏色代碼 + "██" 來顯示
+                put(screenRow, left + 1 + c * 2, BLOCK_GLYPH, cellColor);
+                put(screenRow, left + 2 + c * 2, BLOCK_GLYPH, cellColor);
+            }
+        }
+        put(screenRow, left + 1 + boardContentWidth, '|', 0);
+    }
 
-    // --------------------------
-    // (1) 在遊戲盤面上方顯示分數，並用邊框框起來
-    // --------------------------
-    // 棋盤顯示寬度（不含左邊框兩空格和那個'|'），
-    // 因為我們一格要印2字元，所以是 WIDTH * 2。
-    // 這裡只示範簡單的做法，讓分數邊框跟棋盤寬度一樣。
-    int boardContentWidth = Board::WIDTH * 2;
+    putText(top + 1 + Board::HEIGHT, left, boardBorder);
+}
 
-    // 印分數上邊框
-    std::cout << std::string(offset, ' ') << "  +";
-    for (int i = 0; i < boardContentWidth; ++i) 
+void Renderer::composeGarbage(int lines, int top, int col) 
+{
+    if (lines > Board::HEIGHT) 
+    {
+        lines = Board::HEIGHT;
+    }
+    for (int i = 0; i < lines; ++i) 
     {
-        std::cout << "-";
+        put(top + Board::HEIGHT - i, col, BLOCK_GLYPH, 1);
     }
-    std::cout << "+\n";
+}
 
-    // 印分數內容 (此處簡單印「 Score: xxx 」，可以自行加 padding)
-    // 若想更嚴謹，可計算字串長度，再補空白以對齊邊框長度。
-    std::cout << std::string(offset, ' ') << "  | Score: " 
-              << scoreManager.getScore();
-    // 如果想要在分數後面補足空白對齊，可再計算:
-    int used = 8 + std::to_string(scoreManager.getScore()).size(); // e.g. " Score: " + 分數長度
-    int remain = boardContentWidth - used;
-    for (int i = 0; i < remain; i++) std::cout << " ";
-    std::cout << "|\n";
+void Renderer::composeTimings(const FrameSnapshot& snapshot, int row, int col) 
+{
+    char line[96];
+    putText(row, col, "frame(us)    p50    p99    max");
 
-    // 印分數下邊框
-    std::cout << std::string(offset, ' ') << "  +";
-    for (int i = 0; i < boardContentWidth; ++i) 
+    for (int i = 0; i < static_cast<int>(FramePhase::Count); ++i) 
     {
-        std::cout << "-";
+        FramePhase phase = static_cast<FramePhase>(i);
+        const PhaseTiming& timing = phase == FramePhase::Draw ? drawTiming : snapshot.timings.phases[i];
+        std::snprintf(line, sizeof(line), "%-9s%7llu%7llu%7llu", framePhaseName(phase),
+                      static_cast<unsigned long long>(timing.p50 / 1000),
+                      static_cast<unsigned long long>(timing.p99 / 1000),
+                      static_cast<unsigned long long>(timing.max / 1000));
+        putText(row + 1 + i, col, line);
     }
-    std::cout << "+\n";
+}
+
+void Renderer::flush() 
+{
+    frame.clear();
+    frame += SYNC_BEGIN;
 
-    // --------------------------
-    // (2) 開始印「遊戲盤面」
-    // --------------------------
-    // 上邊框 (跟原本的方式一樣, 只是加上 offset)
-    std::cout << std::string(offset, ' ') << "  +";
-    for (int c = 0; c < boardContentWidth; ++c) 
+    if (!valid) 
     {
-        std::cout << "-";
+        // 第一次繪製或被弄亂：清除整個畫面
+        frame += "\033[H\033[2J";
+        valid = true;
     }
-    std::cout << "+\n";
 
-    // 顯示內容
-    for (int r = 0; r < Board::HEIGHT; ++r) 
+    int currentColor = 0;
+    int cursorRow = -1;
+    int cursorCol = -1;
+    char position[24];
+
+    for (int r = 0; r < SCREEN_ROWS; ++r) 
     {
-        // 左邊框
-        std::cout << std::string(offset, ' ') << "  |";
-        for (int c = 0; c < Board::WIDTH; ++c) 
+        for (int c = 0; c < SCREEN_COLS; ++c) 
         {
-            int cellColor = displayGrid[r][c];
-            if (cellColor == 0) 
+            const Cell& next = back[r][c];
+            Cell& shown = front[r][c];
+
+            if (shown.glyph == next.glyph && shown.color == next.color) 
             {
-                // 空白兩格
-                std::cout << "  ";
-            } 
+                continue;
+            }
+
+            // 只有不連續時才需要移動游標 (終端機座標從 1 開始)
+            if (r != cursorRow || c != cursorCol) 
+            {
+                int n = std::snprintf(position, sizeof(position), "\033[%d;%dH", r + 1, c + 1);
+                frame.append(position, n);
+            }
+
+            if (next.color != currentColor) 
+            {
+                frame += COLOR_CODES[next.color];
+                currentColor = next.color;
+            }
+
+            if (next.glyph == BLOCK_GLYPH) 
+            {
+                frame += "\xE2\x96\x88"; // "█"
+            }
+            else if (next.glyph == GHOST_GLYPH) 
+            {
+                frame += "\xE2\x96\x91"; // "░"
+            }
             else 
             {
-                // 以顏色代碼 + "[]" 來顯示
-                std::cout << getColorCode(cellColor) << "██" << RESET;
+                frame += next.glyph;
             }
+
+            shown = next;
+            cursorRow = r;
+            cursorCol = c + 1;
         }
-        // 右邊框
-        std::cout << "|\n";
     }
 
-    // 下邊框
-    std::cout << std::string(offset, ' ') << "  +";
-    for (int c = 0; c < boardContentWidth; ++c) 
+    if (currentColor != 0) 
     {
-        std::cout << "-";
+        frame += RESET;
     }
-    std::cout << "+\n";
 
-    // 控制提示 (不加入 offset)
-    std::cout << "Controls: [Left/Right=Move], [Up=Rotate], [Down=Drop], [x=Exit]\n";
+    // 狀態列有變動才整行重畫 (ESC[K 清除行尾)
+    int n = std::snprintf(position, sizeof(position), "\033[%d;1H", SCREEN_ROWS + 1);
+    if (status != shownStatus) 
+    {
+        frame.append(position, n);
+        frame += status;
+        frame += "\033[K";
+        shownStatus = status;
+    }
+
+    // 游標停在畫面下方，讓其他訊息印在盤面之外
+    n = std::snprintf(position, sizeof(position), "\033[%d;1H", SCREEN_ROWS + 2);
+    frame.append(position, n);
+    frame += SYNC_END;
+
+    // 先把其他模組經由 std::cout 緩衝的訊息送出，維持輸出順序
+    std::cout.flush();
+
+    // 單次 write()；標準輸入設為非阻塞時，同一個終端機的輸出也可能回傳 EAGAIN
+    const char* data = frame.data();
+    size_t remaining = frame.size();
+    while (remaining > 0) 
+    {
+        ssize_t written = write(fd, data, remaining);
+        if (written > 0) 
+        {
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+        else if (written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) 
+        {
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            poll(&pfd, 1, -1);
+        }
+        else if (written == -1 && errno == EINTR) 
+        {
+            continue;
+        }
+        else 
+        {
+            break;
+        }
+    }
+
+    lastFrameBytes = frame.size();
 }
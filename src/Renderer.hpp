@@ -3,18 +3,104 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <unistd.h>   // for STDOUT_FILENO
 #include "Board.hpp"
 #include "Tetromino.hpp"
 #include "ScoreManager.hpp"
+#include "FrameTimer.hpp"
 
+// 遊戲執行緒發佈給繪製端的一幀狀態 (發佈後不再修改的快照)
+struct FrameSnapshot 
+{
+    Board board;
+    Tetromino tetromino;
+    ScoreManager scoreManager;
+    int level;
+    int countdown;      // >0 表示關卡開始前的倒數秒數
+    bool showTimings;   // 在分數框右側顯示各階段耗時
+    FrameTimingSummary timings;
+
+    // 對戰：對手的盤面顯示在右側，兩邊的待收垃圾顯示在盤面左側
+    bool versus;
+    Board opponentBoard;
+    Tetromino opponentTetromino;
+    int opponentScore;
+    int opponentLevel;
+    int pendingGarbage;
+    int opponentPendingGarbage;
+};
+
+// 雙緩衝差異繪製：每一幀先畫到 back 緩衝，與上一幀 (front) 逐格比較，
+// 只輸出有變動的格子，整幀組成一個位元組緩衝後以單次 write() 送出
 class Renderer 
 {
     public:
-        Renderer();
+        static const int SCREEN_ROWS = 29;   // 格子畫面佔用的行數 (不含最下方的狀態列)
+        static const int SCREEN_COLS = 80;   // 畫面佔用的欄數
+        static const int DEFAULT_BOARD_OFFSET = 20;
+
+    private:
+        // 螢幕上的一格：ASCII 字元 (或方塊標記) 加上顏色編號
+        struct Cell 
+        {
+            char glyph;
+            uint8_t color;
+        };
+
+        int fd;                 // 輸出目標 (預設為標準輸出)
+        bool valid;             // front 是否與終端機上的內容一致
+        std::string frame;      // 預先配置的輸出緩衝
+        std::string status;     // 狀態列 (可含中文，整行比較、整行重畫)
+        std::string shownStatus;
+        size_t lastFrameBytes;  // 上一幀實際寫出的位元組數
+        PhaseTiming drawTiming; // 繪製本身的耗時由繪製執行緒提供，不在快照裡
+        int boardOffset;        // 盤面的水平縮排
+        std::string boardBorder; // 盤面與分數框的上下邊框 (建構時組好，每幀不再配置)
+        std::string levelBorder; // 關卡框的上下邊框
+
+        Cell front[SCREEN_ROWS][SCREEN_COLS];
+        Cell back[SCREEN_ROWS][SCREEN_COLS];
+
+        void put(int row, int col, char glyph, int color);
+        void putText(int row, int col, const char* text, size_t length);
+        void putText(int row, int col, const char* text);
+        void putText(int row, int col, const std::string& text);
+
+        // 把這一幀的內容畫到 back 緩衝
+        void compose(const FrameSnapshot& snapshot);
+
+        // 邊框 + 盤面 + 影子方塊 + 正在操作的方塊，左上角在 (top, left)
+        void composeBoard(const Board& board, const Tetromino& tetromino, int top, int left);
+
+        // 盤面左側的待收垃圾行數 (由下往上的紅色長條)
+        void composeGarbage(int lines, int top, int col);
+
+        // 各階段的 p50 / p99 / max (微秒)
+        void composeTimings(const FrameSnapshot& snapshot, int row, int col);
+
+        // 比較 front/back，組出差異並寫出
+        void flush();
+
+    public:
+        explicit Renderer(int fd = STDOUT_FILENO);
         ~Renderer();
 
-        void draw(const Board& board, const Tetromino& tetromino, const ScoreManager& scoreManager, int level);
+        void draw(const FrameSnapshot& snapshot);
+
+        // 終端機被其他輸出弄亂時呼叫，下一幀會清除畫面並完整重繪
+        void invalidate();
+
+        // 上一幀寫出的位元組數
+        size_t getLastFrameBytes() const;
+
+        // 計時面板中 draw 那一行顯示的數值
+        void setDrawTiming(const PhaseTiming& timing);
+
+        // 盤面的水平縮排 (欄數)
+        void setBoardOffset(int offset);
 };
 
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,427 @@
+#include "Replay.hpp"
+#include "FileFormat.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace 
+{
+    const char REPLAY_MAGIC[4] = { 'O', 'B', 'R', 'P' };
+    const int INPUT_BITS = 6;
+    const int INPUT_BITS_V1 = 5;
+    const int MAX_VARINT_BYTES = 10;
+}
+
+uint64_t hashGameState(const Board& board, const ScoreManager& scoreManager) 
+{
+    uint64_t hash = FNV_OFFSET;
+    for (int r = 0; r < Board::HEIGHT; ++r) 
+    {
+        hash = fnvValue(hash, board.getRowMask(r), 2);
+        for (int c = 0; c < Board::WIDTH; ++c) 
+        {
+            hash = fnvValue(hash, static_cast<uint64_t>(board.getCell(r, c)), 1);
+        }
+    }
+    hash = fnvValue(hash, static_cast<uint32_t>(scoreManager.getScore()), 4);
+    return hash;
+}
+
+uint8_t packInput(const InputState& input) 
+{
+    return static_cast<uint8_t>((input.moveLeft ? 0x01 : 0) | (input.moveRight ? 0x02 : 0) | (input.rotateLeft ? 0x04 : 0)
+                                | (input.rotateRight ? 0x08 : 0) | (input.moveDown ? 0x10 : 0) | (input.hardDrop ? 0x20 : 0));
+}
+
+InputState unpackInput(uint8_t bits) 
+{
+    InputState input;
+    input.moveLeft = bits & 0x01;
+    input.moveRight = bits & 0x02;
+    input.rotateLeft = bits & 0x04;
+    input.rotateRight = bits & 0x08;
+    input.moveDown = bits & 0x10;
+    input.hardDrop = bits & 0x20;
+    return input;
+}
+
+// ---- ReplayRecorder ----
+
+ReplayRecorder::ReplayRecorder()
+: recording(false),
+  lastTick(0),
+  lastBits(0),
+  pendingRun(0)
+{
+    std::memset(&header, 0, sizeof(header));
+}
+
+void ReplayRecorder::begin(uint64_t seed, RandomizerMode mode) 
+{
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+    header.version = REPLAY_VERSION;
+    header.randomizer = static_cast<uint8_t>(mode);
+    header.flags = BUILD_FLAGS;
+    header.seed = seed;
+
+    payload.clear();
+    payload.reserve(4096);
+    recording = true;
+    lastTick = 0;
+    lastBits = 0;
+    pendingRun = 0;
+}
+
+void ReplayRecorder::writeVarint(uint64_t value) 
+{
+    while (value >= 0x80) 
+    {
+        payload.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    payload.push_back(static_cast<uint8_t>(value));
+}
+
+void ReplayRecorder::flushRun() 
+{
+    if (pendingRun > 0) 
+    {
+        writeVarint(static_cast<uint64_t>(pendingRun - 1) << INPUT_BITS);
+        pendingRun = 0;
+    }
+}
+
+void ReplayRecorder::record(uint64_t tick, const InputState& input) 
+{
+    uint8_t bits = packInput(input);
+    if (!recording || bits == 0) 
+    {
+        return;
+    }
+
+    bool first = header.inputCount == 0;
+    header.inputCount++;
+
+    // 與上一個 tick 的輸入相同：只累加重複次數
+    if (!first && bits == lastBits && tick == lastTick + 1) 
+    {
+        pendingRun++;
+        lastTick = tick;
+        return;
+    }
+
+    flushRun();
+
+    // 第一筆相對於 tick -1，所以距離永遠至少是 1
+    uint64_t delta = first ? tick + 1 : tick - lastTick;
+    writeVarint(((delta - 1) << INPUT_BITS) | bits);
+    lastTick = tick;
+    lastBits = bits;
+}
+
+void ReplayRecorder::finish(const Simulator& simulator) 
+{
+    if (!recording) 
+    {
+        return;
+    }
+
+    flushRun();
+    header.ticks = simulator.getTick();
+    header.stateHash = hashGameState(simulator.getBoard(), simulator.getScoreManager());
+    header.score = simulator.getScoreManager().getScore();
+    header.level = simulator.getLevel();
+    header.payloadBytes = static_cast<uint32_t>(payload.size());
+    recording = false;
+}
+
+bool ReplayRecorder::isRecording() const 
+{
+    return recording;
+}
+
+bool ReplayRecorder::save(const std::string& path) const 
+{
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) 
+    {
+        std::perror(path.c_str());
+        return false;
+    }
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1
+           && (payload.empty() || std::fwrite(payload.data(), payload.size(), 1, file) == 1);
+    ok = std::fclose(file) == 0 && ok;
+    return ok;
+}
+
+size_t ReplayRecorder::size() const 
+{
+    return sizeof(header) + payload.size();
+}
+
+// ---- ReplayFile ----
+
+ReplayFile::ReplayFile()
+: mapping(nullptr),
+  length(0)
+{}
+
+ReplayFile::~ReplayFile() 
+{
+    close();
+}
+
+bool ReplayFile::open(const std::string& path, std::string& error) 
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) 
+    {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) 
+    {
+        error = path + ": empty or unreadable file";
+        ::close(fd);
+        return false;
+    }
+
+    void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) 
+    {
+        error = path + ": mmap: " + std::strerror(errno);
+        return false;
+    }
+
+    mapping = p;
+    length = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void ReplayFile::close() 
+{
+    if (mapping) 
+    {
+        munmap(mapping, length);
+        mapping = nullptr;
+        length = 0;
+    }
+}
+
+const uint8_t* ReplayFile::data() const 
+{
+    return static_cast<const uint8_t*>(mapping);
+}
+
+size_t ReplayFile::size() const 
+{
+    return length;
+}
+
+// ---- ReplayPlayer ----
+
+ReplayPlayer::ReplayPlayer()
+: cursor(nullptr),
+  end(nullptr),
+  nextTick(0),
+  nextBits(0),
+  inputBits(INPUT_BITS),
+  runLeft(0),
+  hasNext(false),
+  corrupt(false)
+{
+    std::memset(&header, 0, sizeof(header));
+}
+
+bool ReplayPlayer::load(const uint8_t* data, size_t size, std::string& error) 
+{
+    hasNext = false;
+    corrupt = false;
+    runLeft = 0;
+
+    if (size < sizeof(ReplayHeader)) 
+    {
+        error = "file too small for a replay header";
+        return false;
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic)) != 0) 
+    {
+        error = "not a replay file";
+        return false;
+    }
+    if (header.version != REPLAY_VERSION && header.version != 1) 
+    {
+        error = "unsupported replay version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.randomizer > static_cast<uint8_t>(RandomizerMode::History)) 
+    {
+        error = "unknown randomizer " + std::to_string(header.randomizer);
+        return false;
+    }
+    if (header.flags != BUILD_FLAGS) 
+    {
+        error = header.flags & BUILD_FLAG_TEST_MODE ? "replay was recorded in TEST_MODE" 
+                                                     : "replay was recorded without TEST_MODE";
+        return false;
+    }
+    if (header.payloadBytes > size - sizeof(ReplayHeader)) 
+    {
+        error = "truncated input stream";
+        return false;
+    }
+
+    inputBits = header.version == 1 ? INPUT_BITS_V1 : INPUT_BITS;
+    cursor = data + sizeof(ReplayHeader);
+    end = cursor + header.payloadBytes;
+
+    // 第一筆相對於 tick -1 (無號整數繞回)
+    nextTick = ~0ull;
+    advance();
+    return !corrupt;
+}
+
+bool ReplayPlayer::readVarint(uint64_t& value) 
+{
+    value = 0;
+    for (int i = 0; i < MAX_VARINT_BYTES; ++i) 
+    {
+        if (cursor == end) 
+        {
+            return false;
+        }
+        uint8_t byte = *cursor++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+        if (!(byte & 0x80)) 
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ReplayPlayer::advance() 
+{
+    hasNext = false;
+    if (cursor == end) 
+    {
+        return;
+    }
+
+    uint64_t value;
+    if (!readVarint(value) || (value & ((1u << inputBits) - 1)) == 0) 
+    {
+        corrupt = true;
+        return;
+    }
+
+    nextTick += (value >> inputBits) + 1;
+    nextBits = static_cast<uint8_t>(value & ((1u << inputBits) - 1));
+    hasNext = true;
+
+    // 後面緊接著重複標記的話，這筆輸入會延續到接下來的幾個 tick
+    const uint8_t* save = cursor;
+    if (cursor != end && readVarint(value) && (value & ((1u << inputBits) - 1)) == 0) 
+    {
+        runLeft = static_cast<uint32_t>(value >> inputBits) + 1;
+    }
+    else 
+    {
+        cursor = save;
+    }
+}
+
+const ReplayHeader& ReplayPlayer::getHeader() const 
+{
+    return header;
+}
+
+RandomizerMode ReplayPlayer::getRandomizerMode() const 
+{
+    return static_cast<RandomizerMode>(header.randomizer);
+}
+
+InputState ReplayPlayer::next(uint64_t tick) 
+{
+    if (!hasNext || tick < nextTick) 
+    {
+        return unpackInput(0);
+    }
+    if (tick > nextTick) 
+    {
+        // 呼叫端跳過了某些 tick，之後的輸入都對不上
+        corrupt = true;
+        hasNext = false;
+        return unpackInput(0);
+    }
+
+    InputState input = unpackInput(nextBits);
+    if (runLeft > 0) 
+    {
+        runLeft--;
+        nextTick++;
+    }
+    else 
+    {
+        advance();
+    }
+    return input;
+}
+
+bool ReplayPlayer::isDone() const 
+{
+    return !hasNext;
+}
+
+bool ReplayPlayer::isCorrupt() const 
+{
+    return corrupt;
+}
+
+bool verifyReplay(const uint8_t* data, size_t size, ReplayCheck& result, std::string& error) 
+{
+    std::memset(&result, 0, sizeof(result));
+
+    ReplayPlayer player;
+    if (!player.load(data, size, error)) 
+    {
+        return false;
+    }
+
+    const ReplayHeader& header = player.getHeader();
+    Simulator simulator(header.seed, player.getRandomizerMode());
+    while (simulator.getTick() < header.ticks && !simulator.isOver()) 
+    {
+        simulator.step(player.next(simulator.getTick()));
+    }
+
+    result.ticks = simulator.getTick();
+    result.stateHash = hashGameState(simulator.getBoard(), simulator.getScoreManager());
+    result.score = simulator.getScoreManager().getScore();
+    result.level = simulator.getLevel();
+    result.ok = !player.isCorrupt() && player.isDone() 
+             && result.ticks == header.ticks && result.stateHash == header.stateHash;
+
+    if (player.isCorrupt()) 
+    {
+        error = "corrupt input stream";
+    }
+    else if (!result.ok) 
+    {
+        error = "final state does not match the recording";
+    }
+    return true;
+}
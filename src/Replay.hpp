@@ -0,0 +1,139 @@
+#ifndef REPLAY
+#define REPLAY
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Simulator.hpp"
+
+// 重播檔 = 固定長度檔頭 + 輸入串流。
+// 輸入串流只記錄有輸入的 tick，每筆是一個 LEB128 varint：
+//   (距離上一筆的 tick 數 - 1) << 6 | 輸入位元   (輸入位元不為 0)
+//   (連續重複次數 - 1) << 6                      (上一筆的輸入在接下來的幾個 tick 都一樣，例如按住軟降)
+// 第 1 版沒有硬降，輸入只有 5 個位元 (位移也是 5)，仍可讀取
+// 檔頭與串流都是小端序、欄位自然對齊，可以直接在 mmap 對映的記憶體上解析，不需複製
+
+static const uint16_t REPLAY_VERSION = 2;
+
+struct ReplayHeader 
+{
+    char magic[4];          // "OBRP"
+    uint16_t version;
+    uint8_t randomizer;     // RandomizerMode
+    uint8_t flags;          // BUILD_FLAGS (FileFormat.hpp)
+    uint64_t seed;
+    uint64_t ticks;         // 整局推進的 tick 數
+    uint64_t stateHash;     // 結束時 Board 與 ScoreManager 的雜湊
+    uint32_t inputCount;    // 有輸入的 tick 數
+    uint32_t payloadBytes;  // 輸入串流的位元組數
+    int32_t score;          // 結束時的分數與關卡 (方便不重新模擬就能列出)
+    int32_t level;
+};
+
+static_assert(sizeof(ReplayHeader) == 48, "ReplayHeader 必須是固定的 48 位元組");
+
+// 結束狀態的雜湊 (FNV-1a)：棋盤的佔用與顏色、分數
+uint64_t hashGameState(const Board& board, const ScoreManager& scoreManager);
+
+// 一個 tick 的輸入與 6 個位元互相轉換
+uint8_t packInput(const InputState& input);
+InputState unpackInput(uint8_t bits);
+
+// 錄製：每個 tick 在 Simulator::step() 之前呼叫 record()
+class ReplayRecorder 
+{
+    private:
+        ReplayHeader header;
+        std::vector<uint8_t> payload;
+        bool recording;
+        uint64_t lastTick;      // 上一筆輸入的 tick
+        uint8_t lastBits;       // 上一筆輸入
+        uint32_t pendingRun;    // 還沒寫出的連續重複次數
+
+        void writeVarint(uint64_t value);
+        void flushRun();
+
+    public:
+        ReplayRecorder();
+
+        void begin(uint64_t seed, RandomizerMode mode);
+        void record(uint64_t tick, const InputState& input);
+
+        // 記下結束狀態 (tick 數、雜湊、分數)
+        void finish(const Simulator& simulator);
+
+        bool isRecording() const;
+        bool save(const std::string& path) const;
+        size_t size() const;
+};
+
+// 以唯讀 mmap 開啟重播檔
+class ReplayFile 
+{
+    private:
+        void* mapping;
+        size_t length;
+
+        ReplayFile(const ReplayFile&);
+        ReplayFile& operator=(const ReplayFile&);
+
+    public:
+        ReplayFile();
+        ~ReplayFile();
+
+        bool open(const std::string& path, std::string& error);
+        void close();
+
+        const uint8_t* data() const;
+        size_t size() const;
+};
+
+// 播放：依 tick 順序呼叫 next()，取回錄製時那個 tick 的輸入
+class ReplayPlayer 
+{
+    private:
+        ReplayHeader header;
+        const uint8_t* cursor;
+        const uint8_t* end;
+        uint64_t nextTick;      // 下一筆輸入所在的 tick
+        uint8_t nextBits;
+        int inputBits;          // 每筆記錄中輸入位元的寬度 (依檔案版本)
+        uint32_t runLeft;       // 目前這筆輸入還要重複的 tick 數
+        bool hasNext;
+        bool corrupt;
+
+        bool readVarint(uint64_t& value);
+        void advance();
+
+    public:
+        ReplayPlayer();
+
+        // 檢查檔頭並準備播放 (data 必須在播放期間保持有效)
+        bool load(const uint8_t* data, size_t size, std::string& error);
+
+        const ReplayHeader& getHeader() const;
+        RandomizerMode getRandomizerMode() const;
+
+        InputState next(uint64_t tick);
+
+        // 輸入串流是否已經讀完 / 是否有損毀
+        bool isDone() const;
+        bool isCorrupt() const;
+};
+
+// 無頭、不限速地重新模擬整局並比對結束狀態
+struct ReplayCheck 
+{
+    bool ok;
+    uint64_t ticks;
+    uint64_t stateHash;
+    int score;
+    int level;
+};
+
+bool verifyReplay(const uint8_t* data, size_t size, ReplayCheck& result, std::string& error);
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef RINGBUFFER
+#define RINGBUFFER
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// 單一寫入者 / 單一讀取者的無鎖環狀緩衝。
+// 容量在建構時決定 (進位到 2 的次方)，之後推入與取出都不會配置記憶體
+template <typename T>
+class RingBuffer 
+{
+    private:
+        std::vector<T> slots;
+        size_t mask;
+        std::atomic<size_t> head;   // 讀取位置 (只有讀取者寫入)
+        std::atomic<size_t> tail;   // 寫入位置 (只有寫入者寫入)
+
+    public:
+        explicit RingBuffer(size_t capacity)
+        : head(0),
+          tail(0)
+        {
+            size_t size = 1;
+            while (size < capacity) 
+            {
+                size <<= 1;
+            }
+            slots.resize(size);
+            mask = size - 1;
+        }
+
+        size_t capacity() const 
+        {
+            return slots.size();
+        }
+
+        // 目前可讀取的元素數 (讀寫兩端都可呼叫，結果只是當下的近似值)
+        size_t size() const 
+        {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+        // 寫入者：推入一個元素，滿了回傳 false
+        bool push(const T& value) 
+        {
+            return write(&value, 1) == 1;
+        }
+
+        // 讀取者：取出一個元素，空的回傳 false
+        bool pop(T& value) 
+        {
+            return read(&value, 1) == 1;
+        }
+
+        // 寫入者：盡量寫入 count 個元素，回傳實際寫入數
+        size_t write(const T* data, size_t count) 
+        {
+            size_t t = tail.load(std::memory_order_relaxed);
+            size_t space = slots.size() - (t - head.load(std::memory_order_acquire));
+            if (count > space) 
+            {
+                count = space;
+            }
+            for (size_t i = 0; i < count; ++i) 
+            {
+                slots[(t + i) & mask] = data[i];
+            }
+            tail.store(t + count, std::memory_order_release);
+            return count;
+        }
+
+        // 讀取者：盡量讀出 count 個元素，回傳實際讀出數
+        size_t read(T* data, size_t count) 
+        {
+            size_t h = head.load(std::memory_order_relaxed);
+            size_t available = tail.load(std::memory_order_acquire) - h;
+            if (count > available) 
+            {
+                count = available;
+            }
+            for (size_t i = 0; i < count; ++i) 
+            {
+                data[i] = slots[(h + i) & mask];
+            }
+            head.store(h + count, std::memory_order_release);
+            return count;
+        }
+
+        // 讀取者：丟棄所有目前可讀的元素
+        void clear() 
+        {
+            head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+        }
+};
+
+#endif
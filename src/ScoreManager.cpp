@@ -1,16 +1,20 @@
 #include "ScoreManager.hpp"
 
-ScoreManager::ScoreManager(): score(0) {}
+ScoreManager::ScoreManager(): score(0), lines(0) {}
 
-ScoreManager::~ScoreManager() {}
-
-void ScoreManager::addScore(int linesCleared) 
+void ScoreManager::addScore(const LineClearResult& result) 
 {
     // 一個簡單演算法：每消一行給 100 分
-    score += linesCleared * 100;
+    score += result.count * 100;
+    lines += result.count;
 }
 
 int ScoreManager::getScore() const 
 {
     return score;
 }
+
+int ScoreManager::getLines() const 
+{
+    return lines;
+}
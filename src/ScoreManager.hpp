@@ -3,20 +3,25 @@
 
 #pragma once
 
+#include "Board.hpp"
+
 class ScoreManager 
 {
     private:
         int score;
+        int lines;   // 累計消除的行數
 
     public:
         ScoreManager();
-        ~ScoreManager();
 
-        // 依照消除行數增加分數
-        void addScore(int linesCleared);
+        // 依照消行結果增加分數
+        void addScore(const LineClearResult& result);
 
         // 取得目前分數
         int getScore() const;
+
+        // 取得累計消除的行數
+        int getLines() const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,331 @@
+#include "Simulator.hpp"
+#include <cstring>
+
+#ifdef TEST_MODE
+const int SimulatorBase::DEFAULT_LEVEL_THRESHOLDS[MAX_LEVEL] = {100, 100, 100, 100, 100, 100, 100, 100, 100, 100}; // 測試模式：每 100 分升級
+const int SimulatorBase::DEFAULT_GRAVITY_MS[MAX_LEVEL] = {1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000, 1000}; // 測試模式：不加速
+#else
+const int SimulatorBase::DEFAULT_LEVEL_THRESHOLDS[MAX_LEVEL] = {1000, 2500, 5000, 8000, 12000, 16000, 20000, 25000, 30000, 40000}; // 正式模式
+const int SimulatorBase::DEFAULT_GRAVITY_MS[MAX_LEVEL] = {1000, 900, 800, 700, 600, 500, 420, 320, 230, 130}; // 正式模式
+#endif
+
+template <class BoardT>
+BasicSimulator<BoardT>::BasicSimulator(uint64_t seed, RandomizerMode mode)
+: dropTimerMs(0),
+  level(1),
+  over(false),
+  tick(0),
+  seed(seed),
+  randomizer(seed, mode),
+  garbageRng(seed ^ 0x6A09E667F3BCC909ull),
+  pendingGarbage(0)
+{
+    // 第一個方塊也由產生器決定，整局都只取決於種子
+    TetrominoType type = randomizer.nextType();
+    currentTetromino.reset(type, randomizer.nextColor(), BoardT::SPAWN_COL);
+
+    setLevelThresholds(DEFAULT_LEVEL_THRESHOLDS);
+    setGravityMs(DEFAULT_GRAVITY_MS);
+}
+
+template <class BoardT>
+BasicSimulator<BoardT>::~BasicSimulator() {}
+
+template <class BoardT>
+void BasicSimulator<BoardT>::setLevelThresholds(const int (&thresholds)[MAX_LEVEL]) 
+{
+    for (int i = 0; i < MAX_LEVEL; ++i) 
+    {
+        levelThresholds[i] = thresholds[i];
+    }
+}
+
+template <class BoardT>
+void BasicSimulator<BoardT>::setGravityMs(const int (&gravity)[MAX_LEVEL]) 
+{
+    for (int i = 0; i < MAX_LEVEL; ++i) 
+    {
+        gravityMs[i] = gravity[i];
+    }
+}
+
+template <class BoardT>
+void BasicSimulator<BoardT>::receiveGarbage(int lines) 
+{
+    pendingGarbage += lines;
+}
+
+template <class BoardT>
+int BasicSimulator<BoardT>::getPendingGarbage() const 
+{
+    return pendingGarbage;
+}
+
+template <class BoardT>
+void BasicSimulator<BoardT>::saveState(State& state) const 
+{
+    state.board = board;
+    state.scoreManager = scoreManager;
+    state.randomizer = randomizer;
+    state.garbageRng = garbageRng;
+    state.seed = seed;
+    state.tick = tick;
+    state.dropTimerMs = dropTimerMs;
+    state.level = level;
+    state.pendingGarbage = pendingGarbage;
+    std::memcpy(state.levelThresholds, levelThresholds, sizeof(levelThresholds));
+    std::memcpy(state.gravityMs, gravityMs, sizeof(gravityMs));
+    state.pieceRow = currentTetromino.getPosition().first;
+    state.pieceCol = currentTetromino.getPosition().second;
+    state.pieceColor = currentTetromino.getColor();
+    state.pieceType = static_cast<uint8_t>(currentTetromino.getType());
+    state.pieceRotation = static_cast<uint8_t>(currentTetromino.getRotation());
+    state.over = over ? 1 : 0;
+}
+
+template <class BoardT>
+void BasicSimulator<BoardT>::loadState(const State& state) 
+{
+    board = state.board;
+    scoreManager = state.scoreManager;
+    randomizer = state.randomizer;
+    garbageRng = state.garbageRng;
+    seed = state.seed;
+    tick = state.tick;
+    dropTimerMs = state.dropTimerMs;
+    level = state.level;
+    pendingGarbage = state.pendingGarbage;
+    std::memcpy(levelThresholds, state.levelThresholds, sizeof(levelThresholds));
+    std::memcpy(gravityMs, state.gravityMs, sizeof(gravityMs));
+    currentTetromino.reset(static_cast<TetrominoType>(state.pieceType % 7), state.pieceColor, state.pieceCol);
+    currentTetromino.moveTo(state.pieceRow, state.pieceCol, state.pieceRotation);
+    over = state.over != 0;
+}
+
+template <class BoardT>
+StepEvents BasicSimulator<BoardT>::step(const InputState& input) 
+{
+    StepEvents events = {};
+
+    if (over) 
+    {
+        return events;
+    }
+
+    applyInput(input, events);
+    if (events.hardDropped) 
+    {
+        // 硬降已經固定了方塊，新方塊從頭計算重力
+        dropTimerMs = 0;
+        lockTetromino(events);
+    }
+    else 
+    {
+        applyGravity(events);
+    }
+    tick++;
+
+    return events;
+}
+
+template <class BoardT>
+void BasicSimulator<BoardT>::applyInput(const InputState& input, StepEvents& events) 
+{
+    if (input.moveLeft) 
+    {
+        currentTetromino.moveLeft();
+        if (board.checkCollision(currentTetromino)) 
+        {
+            currentTetromino.moveRight();
+        } 
+        else 
+        {
+            events.moved = true;
+        }
+    }
+
+    if (input.moveRight) 
+    {
+        currentTetromino.moveRight();
+        if (board.checkCollision(currentTetromino)) 
+        {
+            currentTetromino.moveLeft();
+        } 
+        else 
+        {
+            events.moved = true;
+        }
+    }
+
+    if (input.rotateLeft) 
+    {
+        currentTetromino.rotateLeft();
+        if (board.checkCollision(currentTetromino)) 
+        {
+            currentTetromino.rotateRight();
+        } 
+        else 
+        {
+            events.rotated = true;
+        }
+    }
+
+    if (input.rotateRight) 
+    {
+        currentTetromino.rotateRight();
+        if (board.checkCollision(currentTetromino)) 
+        {
+            currentTetromino.rotateLeft();
+        } 
+        else 
+        {
+            events.rotated = true;
+        }
+    }
+
+    // 落點由天際線查表，不必逐格檢查碰撞
+    if (input.moveDown && currentTetromino.getPosition().first < board.getDropRow(currentTetromino)) 
+    {
+        currentTetromino.moveDown();
+        events.moved = true;
+    }
+
+    if (input.hardDrop) 
+    {
+        currentTetromino.dropTo(board.getDropRow(currentTetromino));
+        events.hardDropped = true;
+    }
+}
+
+template <class BoardT>
+void BasicSimulator<BoardT>::applyGravity(StepEvents& events) 
+{
+    dropTimerMs += TICK_MS;
+    if (dropTimerMs < gravityMs[level - 1]) 
+    {
+        return;
+    }
+
+    dropTimerMs = 0;  
+
+    if (currentTetromino.getPosition().first < board.getDropRow(currentTetromino)) 
+    {
+        currentTetromino.moveDown();
+        events.dropped = true;
+        return;
+    }
+
+    lockTetromino(events);
+}
+
+template <class BoardT>
+void BasicSimulator<BoardT>::lockTetromino(StepEvents& events) 
+{
+    board.placeTetromino(currentTetromino);
+    events.locked = true;
+
+    events.lines = board.clearLines();
+    if (events.lines.count > 0) 
+    {
+        scoreManager.addScore(events.lines);
+
+        // 攻擊先抵銷自己待收的垃圾，剩下的才送出
+        static const int ATTACK[5] = {0, 0, 1, 2, 4};
+        int attack = ATTACK[events.lines.count];
+        int cancel = attack < pendingGarbage ? attack : pendingGarbage;
+        pendingGarbage -= cancel;
+        events.garbageSent = attack - cancel;
+    }
+    else if (pendingGarbage > 0) 
+    {
+        events.garbageReceived = pendingGarbage;
+        int hole = static_cast<int>(garbageRng.nextBelow(BoardT::WIDTH));
+        bool fits = board.addGarbage(pendingGarbage, hole, GARBAGE_COLOR);
+        pendingGarbage = 0;
+        if (!fits) 
+        {
+            events.gameOver = true;
+            over = true;
+            return;
+        }
+    }
+
+    if (level <= MAX_LEVEL && scoreManager.getScore() >= levelThresholds[level - 1]) 
+    {
+        nextLevel(events);
+    }
+
+    TetrominoType nextType = randomizer.nextType();
+    currentTetromino.reset(nextType, randomizer.nextColor(), BoardT::SPAWN_COL);
+
+    if (board.checkCollision(currentTetromino)) 
+    {
+        events.gameOver = true;
+        over = true;
+    }
+}
+
+template <class BoardT>
+void BasicSimulator<BoardT>::nextLevel(StepEvents& events) 
+{
+    level++;
+    events.levelUp = true;
+
+    if (level > MAX_LEVEL) 
+    {
+        events.completed = true;
+        over = true;
+    }
+}
+
+template <class BoardT>
+const BoardT& BasicSimulator<BoardT>::getBoard() const 
+{
+    return board;
+}
+
+template <class BoardT>
+const Tetromino& BasicSimulator<BoardT>::getTetromino() const 
+{
+    return currentTetromino;
+}
+
+template <class BoardT>
+const ScoreManager& BasicSimulator<BoardT>::getScoreManager() const 
+{
+    return scoreManager;
+}
+
+template <class BoardT>
+int BasicSimulator<BoardT>::getLevel() const 
+{
+    return level;
+}
+
+template <class BoardT>
+bool BasicSimulator<BoardT>::isOver() const 
+{
+    return over;
+}
+
+template <class BoardT>
+unsigned long long BasicSimulator<BoardT>::getTick() const 
+{
+    return tick;
+}
+
+template <class BoardT>
+uint64_t BasicSimulator<BoardT>::getSeed() const 
+{
+    return seed;
+}
+
+template <class BoardT>
+RandomizerMode BasicSimulator<BoardT>::getRandomizerMode() const 
+{
+    return randomizer.getMode();
+}
+
+#define SIMULATOR_INSTANTIATE(w, h) template class BasicSimulator<BasicBoard<w, h> >;
+BOARD_VARIANTS(SIMULATOR_INSTANTIATE)
+#undef SIMULATOR_INSTANTIATE
@@ -0,0 +1,156 @@
+#ifndef SIMULATOR
+#define SIMULATOR
+
+#pragma once
+
+#include <cstdint>
+#include "Board.hpp"
+#include "Tetromino.hpp"
+#include "ScoreManager.hpp"
+#include "Randomizer.hpp"
+
+// 單一 tick 的玩家輸入 (由鍵盤、機器人或測試程式注入)
+struct InputState 
+{
+    bool moveLeft;
+    bool moveRight;
+    bool rotateLeft;
+    bool rotateRight;
+    bool moveDown;
+    bool hardDrop;      // 直接落到底並立刻固定
+};
+
+// 單一 tick 內發生的事件，讓外層決定要播放音效、切換 BGM 或結束遊戲
+struct StepEvents 
+{
+    bool moved;              // 平移或軟降成功
+    bool dropped;            // 重力讓方塊下落一格
+    bool rotated;            // 旋轉成功
+    bool locked;             // 方塊落地並固定到棋盤上
+    bool hardDropped;        // 本 tick 以硬降固定
+    LineClearResult lines;   // 本 tick 的消行結果 (沒有消行時 count 為 0)
+    int garbageSent;         // 對戰：這次消行抵銷待收垃圾後要送給對手的行數
+    int garbageReceived;     // 對戰：這次固定方塊時推上來的垃圾行數
+    bool levelUp;            // 進入下一關
+    bool completed;          // 已完成所有關卡
+    bool gameOver;           // 新方塊一出現就碰撞 (堆滿)
+};
+
+template <class BoardT>
+struct BasicSimulatorState;
+
+// 與棋盤尺寸無關的規則常數與難度曲線
+class SimulatorBase 
+{
+    public:
+        static const int MAX_LEVEL = 10;
+        static const int TICK_MS = 10;   // 固定邏輯時間步長 (毫秒)，每次 step() 推進這麼久
+        static const uint64_t DEFAULT_SEED = 5489u;
+        static const int GARBAGE_COLOR = 7;   // 垃圾行的顏色 (白)
+
+        // 內建的難度曲線 (TEST_MODE 時每 100 分升級且不加速)
+        static const int DEFAULT_LEVEL_THRESHOLDS[MAX_LEVEL];
+        static const int DEFAULT_GRAVITY_MS[MAX_LEVEL];
+};
+
+// 無 I/O 的遊戲規則核心：只依照注入的輸入以離散 tick 推進，
+// 不碰終端機、音效，也不 sleep，可以遠快於實際時間執行。
+// 以棋盤型別 (BasicBoard<W, H>) 為模板參數，每一種尺寸各自實體化 (見 BOARD_VARIANTS)
+template <class BoardT>
+class BasicSimulator : public SimulatorBase 
+{
+    public:
+        typedef BoardT BoardType;
+        typedef BasicSimulatorState<BoardT> State;
+
+    private:
+        int dropTimerMs;         // 距離上次重力下落經過的時間 (毫秒)
+        int level;               // 當前關卡
+        bool over;               // 遊戲是否已結束 (堆滿或完成所有關卡)
+        unsigned long long tick; // 已推進的 tick 數
+        uint64_t seed;           // 本局的種子
+        Randomizer randomizer;   // 每局各自的方塊產生器，同一個種子與模式產生同樣的方塊序列
+        Xoshiro256 garbageRng;   // 垃圾行缺口的位置 (獨立的亂數流，不影響方塊序列)
+        int pendingGarbage;      // 對戰：已收到、還沒推上盤面的垃圾行數
+
+        int levelThresholds[MAX_LEVEL];   // 每一關的升級分數門檻
+        int gravityMs[MAX_LEVEL];         // 每一關重力下落一格所需的時間 (毫秒)，與主機速度無關
+
+        BoardT board;
+        Tetromino currentTetromino;
+        ScoreManager scoreManager;
+
+        // 套用玩家輸入 (移動、旋轉、軟降)
+        void applyInput(const InputState& input, StepEvents& events);
+
+        // 重力下落，落地時固定方塊
+        void applyGravity(StepEvents& events);
+
+        // 固定方塊、消行、計分與產生下一個方塊
+        void lockTetromino(StepEvents& events);
+
+        // 進入下一關
+        void nextLevel(StepEvents& events);
+
+    public:
+        explicit BasicSimulator(uint64_t seed = DEFAULT_SEED, RandomizerMode mode = RandomizerMode::Random);
+        ~BasicSimulator();
+
+        // 覆寫各關的升級分數門檻與重力 (毫秒)，供批次模擬調整難度曲線
+        void setLevelThresholds(const int (&thresholds)[MAX_LEVEL]);
+        void setGravityMs(const int (&gravity)[MAX_LEVEL]);
+
+        // 對戰：收到對手送來的垃圾行，下一次固定方塊且沒有消行時才推上盤面
+        void receiveGarbage(int lines);
+        int getPendingGarbage() const;
+
+        // 取出 / 還原完整的遊戲狀態 (存檔用)，還原後繼續推進的結果與沒有中斷時完全相同
+        void saveState(State& state) const;
+        void loadState(const State& state);
+
+        // 推進一個 tick (TICK_MS 毫秒)
+        StepEvents step(const InputState& input);
+
+        const BoardT& getBoard() const;
+        const Tetromino& getTetromino() const;
+        const ScoreManager& getScoreManager() const;
+        int getLevel() const;
+        bool isOver() const;
+        unsigned long long getTick() const;
+        uint64_t getSeed() const;
+        RandomizerMode getRandomizerMode() const;
+};
+
+// BasicSimulator 的完整狀態，只含可以直接寫進檔案的資料 (方塊以種類、旋轉、位置與顏色表示)
+template <class BoardT>
+struct BasicSimulatorState 
+{
+    BoardT board;
+    ScoreManager scoreManager;
+    Randomizer randomizer;
+    Xoshiro256 garbageRng;
+    uint64_t seed;
+    uint64_t tick;
+    int32_t dropTimerMs;
+    int32_t level;
+    int32_t pendingGarbage;
+    int32_t levelThresholds[SimulatorBase::MAX_LEVEL];
+    int32_t gravityMs[SimulatorBase::MAX_LEVEL];
+    int32_t pieceRow;
+    int32_t pieceCol;
+    int32_t pieceColor;
+    uint8_t pieceType;
+    uint8_t pieceRotation;
+    uint8_t over;
+};
+
+// 遊戲本體使用標準棋盤
+typedef BasicSimulator<Board> Simulator;
+typedef BasicSimulatorState<Board> SimulatorState;
+
+// 定義在 Simulator.cpp，只實體化 BOARD_VARIANTS 列出的尺寸
+#define SIMULATOR_EXTERN_TEMPLATE(w, h) extern template class BasicSimulator<BasicBoard<w, h> >;
+BOARD_VARIANTS(SIMULATOR_EXTERN_TEMPLATE)
+#undef SIMULATOR_EXTERN_TEMPLATE
+
+#endif
@@ -0,0 +1,336 @@
+#include "Spectator.hpp"
+#include "InputHandler.hpp"
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>       // for kill()
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const char SPECTATOR_MAGIC[4] = { 'O', 'B', 'S', 'P' };
+
+    // 觀戰端的更新頻率與等待遊戲開始的上限
+    const int SPECTATOR_POLL_MS = 16;
+    const int SPECTATOR_WAIT_MS = 10000;
+}
+
+// ---- SpectatorBroadcast ----
+
+SpectatorBroadcast::SpectatorBroadcast()
+: region(nullptr),
+  published(0)
+{}
+
+SpectatorBroadcast::~SpectatorBroadcast()
+{
+    close();
+}
+
+bool SpectatorBroadcast::open(const std::string& shmName, std::string& error)
+{
+    close();
+
+    // 上一次異常結束留下的同名區塊：先移除，已經對映它的觀眾不受影響
+    shm_unlink(shmName.c_str());
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (fd == -1)
+    {
+        error = shmName + ": " + std::strerror(errno);
+        return false;
+    }
+    if (ftruncate(fd, sizeof(SpectatorRegion)) == -1)
+    {
+        error = shmName + ": " + std::strerror(errno);
+        ::close(fd);
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, sizeof(SpectatorRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        error = shmName + ": " + std::strerror(errno);
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+
+    // ftruncate 之後內容全為 0，atomic 與序號都從 0 開始
+    region = static_cast<SpectatorRegion*>(mapping);
+    region->version = SPECTATOR_VERSION;
+    region->slotCount = SpectatorRegion::SLOTS;
+    region->frameSize = sizeof(SpectatorFrame);
+    region->writerPid = static_cast<int32_t>(getpid());
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(region->magic, SPECTATOR_MAGIC, sizeof(region->magic));
+
+    name = shmName;
+    published = 0;
+    return true;
+}
+
+void SpectatorBroadcast::close()
+{
+    if (!region)
+    {
+        return;
+    }
+    region->closed.store(1, std::memory_order_release);
+    munmap(region, sizeof(SpectatorRegion));
+    shm_unlink(name.c_str());
+    region = nullptr;
+}
+
+bool SpectatorBroadcast::isOpen() const
+{
+    return region != nullptr;
+}
+
+void SpectatorBroadcast::publish(const FrameSnapshot& snapshot)
+{
+    if (!region)
+    {
+        return;
+    }
+
+    // 寫進下一個槽位：讀取端讀的是上一個槽位，只有落後整整一圈的讀取端才會碰到正在寫的槽位
+    SpectatorSlot& slot = region->slots[published % SpectatorRegion::SLOTS];
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    SpectatorFrame& frame = slot.frame;
+    const Tetromino& tetromino = snapshot.tetromino;
+    frame.board = snapshot.board;
+    frame.scoreManager = snapshot.scoreManager;
+    frame.level = snapshot.level;
+    frame.countdown = snapshot.countdown;
+    frame.pieceType = static_cast<uint8_t>(tetromino.getType());
+    frame.pieceRotation = static_cast<uint8_t>(tetromino.getRotation());
+    frame.pieceRow = static_cast<int8_t>(tetromino.getPosition().first);
+    frame.pieceCol = static_cast<int8_t>(tetromino.getPosition().second);
+    frame.pieceColor = tetromino.getColor();
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    region->published.store(++published, std::memory_order_release);
+}
+
+// ---- SpectatorView ----
+
+SpectatorView::SpectatorView()
+: region(nullptr),
+  lastPublished(0),
+  retries(0)
+{}
+
+SpectatorView::~SpectatorView()
+{
+    close();
+}
+
+bool SpectatorView::open(const std::string& shmName, std::string& error)
+{
+    close();
+
+    int fd = shm_open(shmName.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        error = shmName + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == -1 || static_cast<size_t>(info.st_size) < sizeof(SpectatorRegion))
+    {
+        error = shmName + ": not an oblivionis broadcast";
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, sizeof(SpectatorRegion), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        error = shmName + ": " + std::strerror(errno);
+        return false;
+    }
+
+    const SpectatorRegion* candidate = static_cast<const SpectatorRegion*>(mapping);
+    if (std::memcmp(candidate->magic, SPECTATOR_MAGIC, sizeof(candidate->magic)) != 0)
+    {
+        // 寫入端可能還在初始化
+        error = shmName + ": not ready";
+        munmap(mapping, sizeof(SpectatorRegion));
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (candidate->version != SPECTATOR_VERSION || candidate->slotCount != SpectatorRegion::SLOTS
+        || candidate->frameSize != sizeof(SpectatorFrame))
+    {
+        error = shmName + ": broadcast from a different version";
+        munmap(mapping, sizeof(SpectatorRegion));
+        return false;
+    }
+
+    region = candidate;
+    lastPublished = 0;
+    retries = 0;
+    return true;
+}
+
+void SpectatorView::close()
+{
+    if (region)
+    {
+        munmap(const_cast<SpectatorRegion*>(region), sizeof(SpectatorRegion));
+        region = nullptr;
+    }
+}
+
+bool SpectatorView::poll(FrameSnapshot& snapshot)
+{
+    if (!region)
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        uint64_t published = region->published.load(std::memory_order_acquire);
+        if (published == lastPublished)
+        {
+            return false;
+        }
+
+        const SpectatorSlot& slot = region->slots[(published - 1) % SpectatorRegion::SLOTS];
+        uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            retries++;
+            continue;
+        }
+
+        SpectatorFrame frame;
+        std::memcpy(&frame, &slot.frame, sizeof(frame));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before)
+        {
+            // 複製途中被覆寫，重讀最新的一幀
+            retries++;
+            continue;
+        }
+
+        snapshot.board = frame.board;
+        snapshot.scoreManager = frame.scoreManager;
+        snapshot.level = frame.level;
+        snapshot.countdown = frame.countdown;
+        snapshot.tetromino.reset(static_cast<TetrominoType>(frame.pieceType % 7), frame.pieceColor, frame.pieceCol);
+        snapshot.tetromino.moveTo(frame.pieceRow, frame.pieceCol, frame.pieceRotation);
+        snapshot.showTimings = false;
+        snapshot.versus = false;
+        lastPublished = published;
+        return true;
+    }
+}
+
+bool SpectatorView::isClosed() const
+{
+    if (!region)
+    {
+        return true;
+    }
+    if (region->closed.load(std::memory_order_acquire))
+    {
+        return true;
+    }
+    // 遊戲行程被強制結束時不會設定 closed
+    return kill(static_cast<pid_t>(region->writerPid), 0) == -1 && errno == ESRCH;
+}
+
+unsigned long SpectatorView::getRetries() const
+{
+    return retries;
+}
+
+int runSpectator(const std::string& name)
+{
+    SpectatorView view;
+    std::string error;
+
+    // 遊戲還沒開始廣播時稍等
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SPECTATOR_WAIT_MS);
+    bool announced = false;
+    while (!view.open(name, error))
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            std::cerr << "[Spectate] " << error << "\n";
+            return 1;
+        }
+        if (!announced)
+        {
+            std::cout << "[Spectate] 等待 " << name << " 開始廣播..." << std::endl;
+            announced = true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    InputHandler inputHandler;
+    inputHandler.initTerminal();
+
+    Renderer renderer;
+    static FrameSnapshot snapshot;
+    unsigned long frames = 0;
+    bool running = true;
+    auto lastCheck = std::chrono::steady_clock::now();
+
+    while (running)
+    {
+        // 只讀取鍵盤的離開鍵；畫面跟著遊戲的發佈頻率，最多每 SPECTATOR_POLL_MS 更新一次
+        if (inputHandler.waitForInput(SPECTATOR_POLL_MS))
+        {
+            inputHandler.processInput();
+        }
+        KeyEvent event;
+        while (inputHandler.pollEvent(event))
+        {
+            if (event.action == InputAction::Quit)
+            {
+                running = false;
+            }
+        }
+
+        if (view.poll(snapshot))
+        {
+            renderer.draw(snapshot);
+            frames++;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastCheck >= std::chrono::seconds(1) || !running)
+        {
+            lastCheck = now;
+            if (view.isClosed())
+            {
+                // 畫出最後一幀再離開
+                if (view.poll(snapshot))
+                {
+                    renderer.draw(snapshot);
+                    frames++;
+                }
+                std::cout << "[Spectate] 遊戲已結束\n";
+                running = false;
+            }
+        }
+    }
+
+    inputHandler.restoreTerminal();
+    std::cout << "[Spectate] 繪製 " << frames << " 幀，重讀 " << view.getRetries() << " 次\n";
+    return 0;
+}
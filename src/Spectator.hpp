@@ -0,0 +1,115 @@
+#ifndef SPECTATOR
+#define SPECTATOR
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <sys/types.h>
+#include "Renderer.hpp"
+
+// 觀戰廣播：遊戲把每一幀的盤面、方塊與分數寫進 POSIX 共享記憶體中的環狀緩衝，
+// 任意數量的 --spectate 行程以唯讀方式對映後自行繪製。
+// 每個槽位是一個 seqlock：寫入前序號變奇數、寫完變偶數；讀取端複製後序號沒變才算數，
+// 否則重讀。寫入端從不等待、也不知道有多少觀眾，多一個觀眾對遊戲行程沒有任何成本
+
+static const uint16_t SPECTATOR_VERSION = 1;
+
+// 共享記憶體中的一幀 (只含可以直接複製的資料)
+struct SpectatorFrame
+{
+    Board board;
+    ScoreManager scoreManager;
+    int32_t level;
+    int32_t countdown;
+    uint8_t pieceType;      // TetrominoType
+    uint8_t pieceRotation;
+    int8_t pieceRow;
+    int8_t pieceCol;
+    int32_t pieceColor;
+};
+
+static_assert(std::is_trivially_copyable<SpectatorFrame>::value, "SpectatorFrame 必須可以直接複製到共享記憶體");
+
+struct alignas(64) SpectatorSlot
+{
+    std::atomic<uint32_t> sequence;   // 奇數表示寫入中
+    SpectatorFrame frame;
+};
+
+struct SpectatorRegion
+{
+    static const int SLOTS = 8;
+
+    char magic[4];                    // "OBSP"，初始化完成後才寫入
+    uint16_t version;
+    uint16_t slotCount;
+    uint32_t frameSize;
+    int32_t writerPid;
+    // 跨行程共用的 atomic 必須是無鎖的 (x86-64 / AArch64 的 32、64 位元都是)
+    std::atomic<uint64_t> published;  // 已發佈的幀數，最新一幀在 (published - 1) % SLOTS
+    std::atomic<uint32_t> closed;     // 遊戲結束
+    SpectatorSlot slots[SLOTS];
+};
+
+// 寫入端 (遊戲行程)
+class SpectatorBroadcast
+{
+    private:
+        SpectatorRegion* region;
+        std::string name;
+        uint64_t published;
+
+    public:
+        SpectatorBroadcast();
+        ~SpectatorBroadcast();
+
+        SpectatorBroadcast(const SpectatorBroadcast&) = delete;
+        SpectatorBroadcast& operator=(const SpectatorBroadcast&) = delete;
+
+        // 建立名為 name 的共享記憶體 (例如 "/oblivionis")，已存在時取代
+        bool open(const std::string& name, std::string& error);
+
+        // 標記遊戲結束並移除名稱 (已經對映的觀眾仍可讀到最後一幀)
+        void close();
+
+        bool isOpen() const;
+
+        // 寫入一幀：只是幾百個位元組的複製，不會等待任何觀眾
+        void publish(const FrameSnapshot& snapshot);
+};
+
+// 讀取端 (觀戰行程)，以唯讀方式對映
+class SpectatorView
+{
+    private:
+        const SpectatorRegion* region;
+        uint64_t lastPublished;
+        unsigned long retries;   // 讀取時因為寫入端同時覆寫而重讀的次數
+
+    public:
+        SpectatorView();
+        ~SpectatorView();
+
+        SpectatorView(const SpectatorView&) = delete;
+        SpectatorView& operator=(const SpectatorView&) = delete;
+
+        bool open(const std::string& name, std::string& error);
+        void close();
+
+        // 有新的一幀時複製到 snapshot 並回傳 true
+        bool poll(FrameSnapshot& snapshot);
+
+        // 遊戲已結束或遊戲行程已不存在
+        bool isClosed() const;
+
+        unsigned long getRetries() const;
+};
+
+// --spectate：等待遊戲開始廣播，之後以實際畫面跟著播放，按 x 離開
+int runSpectator(const std::string& name);
+
+#endif
@@ -1,29 +1,148 @@
 #include "Tetromino.hpp"
-#include <cstdlib> // for rand()
+
+namespace 
+{
+    // 根據不同形狀，事先定義四種旋轉狀態下的每個區塊偏移位置
+    // 索引順序：[TetrominoType][rotationIndex][block]
+    constexpr TetrominoBlocks SHAPES[7][4] = 
+    {
+        // 直條 I：0度、90度、180度、270度
+        // 0度和180度類似，1和270度類似，這裡簡單實作
+        {
+            {{0,0},{0,1},{0,2},{0,3}}, // 水平
+            {{0,0},{1,0},{2,0},{3,0}}, // 垂直
+            {{0,3},{0,2},{0,1},{0,0}}, // 水平反向(可視為180度)
+            {{3,0},{2,0},{1,0},{0,0}}, // 垂直反向(可視為270度)
+        },
+        // 方塊 O 不會改變形狀
+        {
+            {{0,0},{0,1},{1,0},{1,1}},
+            {{0,0},{0,1},{1,0},{1,1}},
+            {{0,0},{0,1},{1,0},{1,1}},
+            {{0,0},{0,1},{1,0},{1,1}},
+        },
+        // T
+        {
+            {{0,0},{0,1},{0,2},{1,1}},
+            {{0,1},{1,0},{1,1},{2,1}},
+            {{1,0},{1,1},{1,2},{0,1}},
+            {{0,0},{1,0},{2,0},{1,1}},
+        },
+        // S
+        {
+            {{0,1},{0,2},{1,0},{1,1}},
+            {{0,0},{1,0},{1,1},{2,1}},
+            {{1,1},{1,2},{2,0},{2,1}},
+            {{0,0},{1,0},{1,1},{2,1}},
+        },
+        // Z
+        {
+            {{0,0},{0,1},{1,1},{1,2}},
+            {{0,1},{1,0},{1,1},{2,0}},
+            {{0,0},{0,1},{1,1},{1,2}},
+            {{0,1},{1,0},{1,1},{2,0}},
+        },
+        // J
+        {
+            {{0,0},{0,1},{0,2},{1,0}},
+            {{0,0},{1,0},{2,0},{2,1}},
+            {{1,2},{1,1},{1,0},{0,2}},
+            {{0,0},{0,1},{1,1},{2,1}},
+        },
+        // L
+        {
+            {{0,0},{0,1},{0,2},{1,2}},
+            {{0,0},{1,0},{2,0},{0,1}},
+            {{1,0},{1,1},{1,2},{0,0}},
+            {{0,0},{1,0},{2,0},{2,-1}}, // 依實際需求微調
+        },
+    };
+
+    // ---- 以下為編譯期由 SHAPES 推導遮罩的輔助函式 (C++11 constexpr 只能單一 return) ----
+
+    constexpr int min2(int a, int b) 
+    {
+        return a < b ? a : b;
+    }
+
+    constexpr int max2(int a, int b) 
+    {
+        return a > b ? a : b;
+    }
+
+    constexpr int minCol(const TetrominoBlocks& b) 
+    {
+        return min2(min2(b[0].second, b[1].second), min2(b[2].second, b[3].second));
+    }
+
+    constexpr int maxCol(const TetrominoBlocks& b) 
+    {
+        return max2(max2(b[0].second, b[1].second), max2(b[2].second, b[3].second));
+    }
+
+    constexpr int minRow(const TetrominoBlocks& b) 
+    {
+        return min2(min2(b[0].first, b[1].first), min2(b[2].first, b[3].first));
+    }
+
+    constexpr int maxRow(const TetrominoBlocks& b) 
+    {
+        return max2(max2(b[0].first, b[1].first), max2(b[2].first, b[3].first));
+    }
+
+    // 第 row 行中所有區塊的位元 (以 minCol 為位元 0)
+    constexpr uint16_t rowMask(const TetrominoBlocks& b, int row, int i = 0) 
+    {
+        return i == 4 ? 0 : static_cast<uint16_t>(
+            (b[i].first == row ? (1u << (b[i].second - minCol(b))) : 0u) | rowMask(b, row, i + 1));
+    }
+
+    // 第 col 欄 (以 minCol 為第 0 欄) 最下面區塊的 row，沒有區塊為 -1
+    constexpr int8_t columnBottom(const TetrominoBlocks& b, int col, int i = 0) 
+    {
+        return i == 4 ? -1 : static_cast<int8_t>(
+            max2(b[i].second - minCol(b) == col ? b[i].first : -1, columnBottom(b, col, i + 1)));
+    }
+
+    constexpr TetrominoMask makeMask(const TetrominoBlocks& b) 
+    {
+        return TetrominoMask{ {rowMask(b, 0), rowMask(b, 1), rowMask(b, 2), rowMask(b, 3)},
+                              minCol(b), maxCol(b), minRow(b), maxRow(b),
+                              {columnBottom(b, 0), columnBottom(b, 1), columnBottom(b, 2), columnBottom(b, 3)} };
+    }
+
+    #define TETROMINO_MASKS(t) \
+        { makeMask(SHAPES[t][0]), makeMask(SHAPES[t][1]), makeMask(SHAPES[t][2]), makeMask(SHAPES[t][3]) }
+
+    constexpr TetrominoMask MASKS[7][4] = 
+    {
+        TETROMINO_MASKS(0), TETROMINO_MASKS(1), TETROMINO_MASKS(2), TETROMINO_MASKS(3),
+        TETROMINO_MASKS(4), TETROMINO_MASKS(5), TETROMINO_MASKS(6),
+    };
+
+    #undef TETROMINO_MASKS
+
+    // 確認遮罩確實在編譯期算出
+    static_assert(MASKS[0][0].rows[0] == 0xF, "I 水平遮罩應為 0b1111");
+    static_assert(MASKS[6][3].minCol == -1 && MASKS[6][3].rows[2] == 0x3, "L 270度遮罩錯誤");
+    static_assert(MASKS[2][0].bottom[0] == 0 && MASKS[2][0].bottom[1] == 1 && MASKS[2][0].bottom[3] == -1, "T 0度欄底部錯誤");
+}
 
 Tetromino::Tetromino()
 : type(TetrominoType::I),
   position({0, 4}),
   rotationIndex(0),
   color(1) // 預設給一個顏色 (例如 1)
-{
-    setShape(type);
-    updateBlocks();
-}
+{}
 
 Tetromino::~Tetromino() {}
 
-void Tetromino::reset(TetrominoType t) 
+void Tetromino::reset(TetrominoType t, int c, int col) 
 {
     type = t;
-    position = {0, 4};
+    position = {0, col};
     rotationIndex = 0;
-
-    // 隨機決定顏色 (1~7)
-    color = (std::rand() % 7) + 1;
-
-    setShape(type);
-    updateBlocks();
+    color = c;
 }
 
 int Tetromino::getColor() const 
@@ -51,16 +170,25 @@ void Tetromino::moveUp()
     position.first--;
 }
 
+void Tetromino::dropTo(int row) 
+{
+    position.first = row;
+}
+
+void Tetromino::moveTo(int row, int col, int rotation) 
+{
+    position = {row, col};
+    rotationIndex = rotation & 3;
+}
+
 void Tetromino::rotateLeft() 
 {
     rotationIndex = (rotationIndex + 3) % 4; // 相當於 -1 (mod 4)
-    updateBlocks();
 }
 
 void Tetromino::rotateRight() 
 {
     rotationIndex = (rotationIndex + 1) % 4; // 相當於 +1 (mod 4)
-    updateBlocks();
 }
 
 std::pair<int,int> Tetromino::getPosition() const 
@@ -68,72 +196,22 @@ std::pair<int,int> Tetromino::getPosition() const
     return position;
 }
 
-std::vector<std::pair<int,int>> Tetromino::getBlocks() const 
+const TetrominoBlocks& Tetromino::getBlocks() const 
 {
-    return currentBlocks;
+    return SHAPES[static_cast<int>(type)][rotationIndex];
 }
 
-TetrominoType Tetromino::getType() const 
+const TetrominoMask& Tetromino::getMask() const 
 {
-    return type;
+    return MASKS[static_cast<int>(type)][rotationIndex];
 }
 
-// 根據不同行狀，事先定義四種旋轉狀態下的每個區塊偏移位置
-void Tetromino::setShape(TetrominoType t) 
+TetrominoType Tetromino::getType() const 
 {
-    shapes.clear();
-
-    switch(t) 
-    {
-        case TetrominoType::I:
-            // 直條 I：0度、90度、180度、270度
-            // 0度和180度類似，1和270度類似，這裡簡單實作
-            shapes.push_back({{0,0},{0,1},{0,2},{0,3}}); // 水平
-            shapes.push_back({{0,0},{1,0},{2,0},{3,0}}); // 垂直
-            shapes.push_back({{0,3},{0,2},{0,1},{0,0}}); // 水平反向(可視為180度)
-            shapes.push_back({{3,0},{2,0},{1,0},{0,0}}); // 垂直反向(可視為270度)
-            break;
-        case TetrominoType::O:
-            // 方塊 O 不會改變形狀
-            shapes.push_back({{0,0},{0,1},{1,0},{1,1}});
-            shapes.push_back({{0,0},{0,1},{1,0},{1,1}});
-            shapes.push_back({{0,0},{0,1},{1,0},{1,1}});
-            shapes.push_back({{0,0},{0,1},{1,0},{1,1}});
-            break;
-        case TetrominoType::T:
-            shapes.push_back({{0,0},{0,1},{0,2},{1,1}});
-            shapes.push_back({{0,1},{1,0},{1,1},{2,1}});
-            shapes.push_back({{1,0},{1,1},{1,2},{0,1}});
-            shapes.push_back({{0,0},{1,0},{2,0},{1,1}});
-            break;
-        case TetrominoType::S:
-            shapes.push_back({{0,1},{0,2},{1,0},{1,1}});
-            shapes.push_back({{0,0},{1,0},{1,1},{2,1}});
-            shapes.push_back({{1,1},{1,2},{2,0},{2,1}});
-            shapes.push_back({{0,0},{1,0},{1,1},{2,1}});
-            break;
-        case TetrominoType::Z:
-            shapes.push_back({{0,0},{0,1},{1,1},{1,2}});
-            shapes.push_back({{0,1},{1,0},{1,1},{2,0}});
-            shapes.push_back({{0,0},{0,1},{1,1},{1,2}});
-            shapes.push_back({{0,1},{1,0},{1,1},{2,0}});
-            break;
-        case TetrominoType::J:
-            shapes.push_back({{0,0},{0,1},{0,2},{1,0}});
-            shapes.push_back({{0,0},{1,0},{2,0},{2,1}});
-            shapes.push_back({{1,2},{1,1},{1,0},{0,2}});
-            shapes.push_back({{0,0},{0,1},{1,1},{2,1}});
-            break;
-        case TetrominoType::L:
-            shapes.push_back({{0,0},{0,1},{0,2},{1,2}});
-            shapes.push_back({{0,0},{1,0},{2,0},{0,1}});
-            shapes.push_back({{1,0},{1,1},{1,2},{0,0}});
-            shapes.push_back({{0,0},{1,0},{2,0},{2,-1}}); // 依實際需求微調
-            break;
-    }
+    return type;
 }
 
-void Tetromino::updateBlocks() 
+int Tetromino::getRotation() const 
 {
-    currentBlocks = shapes[rotationIndex];
+    return rotationIndex;
 }
@@ -2,7 +2,7 @@
 #define TEROMINO
 
 #pragma once
-#include <vector>
+#include <cstdint>
 #include <utility>
 
 enum class TetrominoType 
@@ -10,6 +10,20 @@ enum class TetrominoType
     I, O, T, S, Z, J, L
 };
 
+// 單一旋轉狀態下，四個區塊相對於 (row, col) 的偏移量
+typedef std::pair<int,int> TetrominoBlocks[4];
+
+// 單一旋轉狀態的逐行佔用遮罩，由區塊表在編譯期產生
+struct TetrominoMask 
+{
+    uint16_t rows[4];   // 第 i 行的遮罩，位元 0 對應 minCol
+    int minCol;         // 最左邊區塊的 col 偏移量
+    int maxCol;         // 最右邊區塊的 col 偏移量
+    int minRow;         // 最上面區塊的 row 偏移量
+    int maxRow;         // 最下面區塊的 row 偏移量
+    int8_t bottom[4];   // 第 j 欄 (以 minCol 為第 0 欄) 最下面區塊的 row 偏移量，沒有區塊為 -1
+};
+
 class Tetromino 
 {
     private:
@@ -19,39 +33,40 @@ class Tetromino
         // 隨機顏色編號，非 0
         int color;                           
 
-        // 形狀在不同旋轉狀態下的區塊座標
-        std::vector<std::vector<std::pair<int,int>>> shapes;
-        // 目前旋轉索引對應的區塊 (快取)
-        std::vector<std::pair<int,int>> currentBlocks;
-
-        void setShape(TetrominoType t);
-        void updateBlocks();
-
     public:
         Tetromino();
         ~Tetromino();
 
-        // 指定形狀重置位置與旋轉狀態，同時也重新決定顏色
-        void reset(TetrominoType type);
+        // 指定形狀與顏色 (1~7) 重置旋轉狀態，放到第 0 行第 col 欄 (棋盤的 SPAWN_COL)
+        void reset(TetrominoType type, int color, int col);
 
         // 移動、旋轉操作
         void moveLeft();
         void moveRight();
         void moveDown();
         void moveUp();
+        // 直接移到第 row 行 (硬降)
+        void dropTo(int row);
+        // 直接放到指定的位置與旋轉狀態 (由快照重建方塊)
+        void moveTo(int row, int col, int rotation);
         void rotateLeft();
         void rotateRight();
 
         // 取得當前方塊在棋盤的絕對位置 (row, col)
         std::pair<int,int> getPosition() const;
-        // 取得此形狀目前旋轉狀態下，相對於 (row, col) 的各個區塊偏移量
-        std::vector<std::pair<int,int>> getBlocks() const;
+        // 取得此形狀目前旋轉狀態下，相對於 (row, col) 的各個區塊偏移量 (指向靜態表，不配置記憶體)
+        const TetrominoBlocks& getBlocks() const;
+        // 取得此形狀目前旋轉狀態下的逐行遮罩
+        const TetrominoMask& getMask() const;
 
         // 取得現在的形狀
         TetrominoType getType() const;
 
+        // 取得目前的旋轉狀態 (0~3)
+        int getRotation() const;
+
         // 取得方塊顏色
         int getColor() const;
 };
 
-#endif
\ No newline at end of file
+#endif
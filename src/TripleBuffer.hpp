@@ -0,0 +1,64 @@
+#ifndef TRIPLEBUFFER
+#define TRIPLEBUFFER
+
+#pragma once
+
+#include <atomic>
+
+// 單一寫入者 / 單一讀取者的無鎖三緩衝：
+// 寫入者永遠有一個自己的緩衝可寫，讀取者永遠拿到最新發佈的那一份，
+// 讀取者跟不上時，中間的舊資料直接被覆蓋 (丟幀) 而不會排隊
+template <typename T>
+class TripleBuffer 
+{
+    private:
+        // middle 的低兩位元是緩衝索引，FRESH 位元表示有尚未被讀取的新資料
+        static const unsigned INDEX_MASK = 0x3;
+        static const unsigned FRESH = 0x4;
+
+        T buffers[3];
+        unsigned writeIndex;            // 只有寫入者使用
+        unsigned readIndex;             // 只有讀取者使用
+        std::atomic<unsigned> middle;   // 兩邊交換用
+
+    public:
+        TripleBuffer()
+        : writeIndex(0),
+          readIndex(1),
+          middle(2)
+        {}
+
+        // 寫入者：取得目前可寫的緩衝
+        T& writeBuffer() 
+        {
+            return buffers[writeIndex];
+        }
+
+        // 寫入者：發佈剛寫好的緩衝，換回中間那一份繼續寫
+        void publish() 
+        {
+            unsigned previous = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+            writeIndex = previous & INDEX_MASK;
+        }
+
+        // 讀取者：若有新資料就換到手上並回傳 true
+        bool update() 
+        {
+            if (!(middle.load(std::memory_order_relaxed) & FRESH)) 
+            {
+                return false;
+            }
+
+            unsigned previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+            readIndex = previous & INDEX_MASK;
+            return true;
+        }
+
+        // 讀取者：取得最近一次 update() 換到的緩衝
+        const T& readBuffer() const 
+        {
+            return buffers[readIndex];
+        }
+};
+
+#endif
@@ -0,0 +1,336 @@
+#include "Versus.hpp"
+#include "Replay.hpp"
+#include "FileFormat.hpp"
+#include <chrono>
+#include <thread>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    const char VERSUS_MAGIC[4] = { 'O', 'B', 'V', 'S' };
+
+    bool makeAddress(const std::string& path, struct sockaddr_un& address, std::string& error)
+    {
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path))
+        {
+            error = "invalid socket path " + path;
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size());
+        return true;
+    }
+}
+
+uint64_t hashVersusState(const Simulator& host, const Simulator& guest)
+{
+    uint64_t hash = hashGameState(host.getBoard(), host.getScoreManager());
+    uint64_t other = hashGameState(guest.getBoard(), guest.getScoreManager());
+    hash ^= other + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+void stepVersus(Simulator& host, Simulator& guest, const InputState& hostInput, const InputState& guestInput,
+                StepEvents& hostEvents, StepEvents& guestEvents)
+{
+    hostEvents = host.step(hostInput);
+    guestEvents = guest.step(guestInput);
+
+    // 兩邊都推進完才互送，同一個 tick 送出的垃圾不會影響對方這個 tick 的結果
+    if (hostEvents.garbageSent > 0)
+    {
+        guest.receiveGarbage(hostEvents.garbageSent);
+    }
+    if (guestEvents.garbageSent > 0)
+    {
+        host.receiveGarbage(guestEvents.garbageSent);
+    }
+}
+
+VersusLink::VersusLink()
+: fd(-1),
+  hosting(false)
+{}
+
+VersusLink::~VersusLink()
+{
+    close();
+}
+
+bool VersusLink::host(const std::string& path, uint64_t seed, RandomizerMode mode, std::string& error)
+{
+    close();
+
+    struct sockaddr_un address;
+    if (!makeAddress(path, address, error))
+    {
+        return false;
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener == -1)
+    {
+        error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+
+    // 上一次異常結束留下的 socket 檔
+    unlink(path.c_str());
+    if (bind(listener, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == -1
+        || listen(listener, 1) == -1)
+    {
+        error = path + ": " + std::strerror(errno);
+        ::close(listener);
+        return false;
+    }
+
+    do
+    {
+        fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    } while (fd == -1 && errno == EINTR);
+
+    int acceptError = errno;
+    ::close(listener);
+    unlink(path.c_str());
+    if (fd == -1)
+    {
+        error = std::string("accept: ") + std::strerror(acceptError);
+        return false;
+    }
+
+    hosting = true;
+
+    VersusHandshake handshake;
+    std::memcpy(handshake.magic, VERSUS_MAGIC, sizeof(handshake.magic));
+    handshake.version = VERSUS_VERSION;
+    handshake.randomizer = static_cast<uint8_t>(mode);
+    handshake.flags = BUILD_FLAGS;
+    handshake.seed = seed;
+    if (!sendAll(&handshake, sizeof(handshake), error))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool VersusLink::join(const std::string& path, uint64_t& seed, RandomizerMode& mode, std::string& error)
+{
+    close();
+
+    struct sockaddr_un address;
+    if (!makeAddress(path, address, error))
+    {
+        return false;
+    }
+
+    // 主機可能還沒開始監聽：每 10 ms 重試，最多 TIMEOUT_MS
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TIMEOUT_MS);
+    while (true)
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd == -1)
+        {
+            error = std::string("socket: ") + std::strerror(errno);
+            return false;
+        }
+        if (connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) == 0)
+        {
+            break;
+        }
+
+        int connectError = errno;
+        close();
+        if ((connectError != ENOENT && connectError != ECONNREFUSED) || std::chrono::steady_clock::now() >= deadline)
+        {
+            error = path + ": " + std::strerror(connectError);
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    hosting = false;
+
+    VersusHandshake handshake;
+    if (!recvAll(&handshake, sizeof(handshake), error))
+    {
+        close();
+        return false;
+    }
+    if (std::memcmp(handshake.magic, VERSUS_MAGIC, sizeof(handshake.magic)) != 0 || handshake.version != VERSUS_VERSION)
+    {
+        error = "not an oblivionis versus host (or a different version)";
+        close();
+        return false;
+    }
+    if (handshake.flags != BUILD_FLAGS)
+    {
+        error = "host and guest must both be built with (or without) TEST_MODE";
+        close();
+        return false;
+    }
+    if (handshake.randomizer > static_cast<uint8_t>(RandomizerMode::History))
+    {
+        error = "unknown randomizer " + std::to_string(handshake.randomizer);
+        close();
+        return false;
+    }
+
+    seed = handshake.seed;
+    mode = static_cast<RandomizerMode>(handshake.randomizer);
+    return true;
+}
+
+void VersusLink::close()
+{
+    if (fd != -1)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+bool VersusLink::sendAll(const void* data, size_t size, std::string& error)
+{
+    const char* cursor = static_cast<const char*>(data);
+    while (size > 0)
+    {
+        // 對手已經離開時回傳 EPIPE，不要收到 SIGPIPE
+        ssize_t sent = send(fd, cursor, size, MSG_NOSIGNAL);
+        if (sent > 0)
+        {
+            cursor += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        else if (sent == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            error = std::string("send: ") + std::strerror(errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VersusLink::recvAll(void* data, size_t size, std::string& error)
+{
+    char* cursor = static_cast<char*>(data);
+    while (size > 0)
+    {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int ready = poll(&pfd, 1, TIMEOUT_MS);
+        if (ready == 0)
+        {
+            error = "opponent timed out";
+            return false;
+        }
+        if (ready == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            error = std::string("poll: ") + std::strerror(errno);
+            return false;
+        }
+
+        ssize_t received = recv(fd, cursor, size, 0);
+        if (received > 0)
+        {
+            cursor += received;
+            size -= static_cast<size_t>(received);
+        }
+        else if (received == 0)
+        {
+            error = "opponent disconnected";
+            return false;
+        }
+        else if (errno != EINTR)
+        {
+            error = std::string("recv: ") + std::strerror(errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VersusLink::exchange(uint64_t tick, uint8_t local, uint64_t stateHash, uint8_t& remote, std::string& error)
+{
+    if (fd == -1)
+    {
+        error = "not connected";
+        return false;
+    }
+
+    // 雙方在同一個 tick 附上雜湊，訊息長度一致，不需要額外的封包邊界
+    bool withHash = tick % HASH_INTERVAL == 0;
+    uint8_t message[9];
+    message[0] = local;
+    size_t size = 1;
+    if (withHash)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            message[1 + i] = static_cast<uint8_t>(stateHash >> (8 * i));
+        }
+        size = sizeof(message);
+    }
+
+    if (!sendAll(message, size, error))
+    {
+        return false;
+    }
+
+    uint8_t reply[9];
+    auto begin = std::chrono::steady_clock::now();
+    bool ok = recvAll(reply, size, error);
+    long long waitedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+    waitTimes.record(waitedNs > 0 ? static_cast<uint64_t>(waitedNs) : 0);
+    if (!ok)
+    {
+        return false;
+    }
+
+    remote = reply[0];
+    if (withHash)
+    {
+        uint64_t remoteHash = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            remoteHash |= static_cast<uint64_t>(reply[1 + i]) << (8 * i);
+        }
+        if (remoteHash != stateHash)
+        {
+            error = "desync at tick " + std::to_string(tick);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VersusLink::isHost() const
+{
+    return hosting;
+}
+
+bool VersusLink::isConnected() const
+{
+    return fd != -1;
+}
+
+const LatencyHistogram& VersusLink::getWaitTimes() const
+{
+    return waitTimes;
+}
@@ -0,0 +1,79 @@
+#ifndef VERSUS
+#define VERSUS
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "Simulator.hpp"
+#include "FrameTimer.hpp"
+
+// 本機雙人對戰：兩個行程以 Unix domain socket 連線，採確定性的 lockstep。
+// 雙方都模擬兩個盤面 (同一個種子、同一套規則)，每個 tick 只交換 1 個位元組的輸入：
+//   低 6 位元 = packInput() 的輸入，VERSUS_QUIT = 離開
+// 每 HASH_INTERVAL 個 tick 在輸入後附上 8 個位元組的狀態雜湊，用來偵測不同步。
+// 同一台機器上來回只要幾微秒，不需要 rollback 或輸入延遲
+
+static const uint16_t VERSUS_VERSION = 1;
+static const uint8_t VERSUS_QUIT = 0x40;
+
+// 連線後主機送給對手的開局資訊 (小端序)
+struct VersusHandshake
+{
+    char magic[4];          // "OBVS"
+    uint16_t version;
+    uint8_t randomizer;     // RandomizerMode
+    uint8_t flags;          // BUILD_FLAGS (FileFormat.hpp)
+    uint64_t seed;
+};
+
+static_assert(sizeof(VersusHandshake) == 16, "VersusHandshake 必須是固定的 16 位元組");
+
+// 兩個盤面的結束狀態雜湊 (依主機、對手的順序)
+uint64_t hashVersusState(const Simulator& host, const Simulator& guest);
+
+// 以同一個 tick 的兩份輸入推進兩個盤面，再互相送出垃圾行。
+// 兩邊的行程都以 (主機, 對手) 的順序呼叫，結果完全相同
+void stepVersus(Simulator& host, Simulator& guest, const InputState& hostInput, const InputState& guestInput,
+                StepEvents& hostEvents, StepEvents& guestEvents);
+
+class VersusLink
+{
+    public:
+        static const int HASH_INTERVAL = 256;
+        static const int TIMEOUT_MS = 5000;   // 等待對手的上限 (連線、每個 tick)
+
+    private:
+        int fd;
+        bool hosting;
+        LatencyHistogram waitTimes;   // 每個 tick 等待對手輸入的時間 (奈秒)
+
+        bool sendAll(const void* data, size_t size, std::string& error);
+        bool recvAll(void* data, size_t size, std::string& error);
+
+    public:
+        VersusLink();
+        ~VersusLink();
+
+        VersusLink(const VersusLink&) = delete;
+        VersusLink& operator=(const VersusLink&) = delete;
+
+        // 主機：在 path 建立 socket、等待對手連線，送出開局資訊
+        bool host(const std::string& path, uint64_t seed, RandomizerMode mode, std::string& error);
+
+        // 對手：連線到 path (主機還沒開好時會重試)，取得開局資訊
+        bool join(const std::string& path, uint64_t& seed, RandomizerMode& mode, std::string& error);
+
+        void close();
+
+        // 交換這個 tick 的輸入 (local/remote 為 packInput() 的位元，可加上 VERSUS_QUIT)。
+        // stateHash 是這個 tick 之前的 hashVersusState()，只在 tick 為 HASH_INTERVAL 的倍數時送出比對。
+        // 斷線、逾時或不同步時回傳 false
+        bool exchange(uint64_t tick, uint8_t local, uint64_t stateHash, uint8_t& remote, std::string& error);
+
+        bool isHost() const;
+        bool isConnected() const;
+        const LatencyHistogram& getWaitTimes() const;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef XOSHIRO
+#define XOSHIRO
+
+#pragma once
+
+#include <cstdint>
+
+// xoshiro256** 亂數產生器：狀態只有 32 位元組，每次產生只需幾個位移與乘法。
+// 每局擁有自己的一份，平行模擬之間沒有共用狀態；同一個種子永遠產生同樣的序列
+class Xoshiro256 
+{
+    private:
+        uint64_t s[4];
+
+        static uint64_t rotl(uint64_t x, int k) 
+        {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        // 以 splitmix64 把任意種子 (包含 0 與相鄰的整數) 展開成分布良好的初始狀態
+        static uint64_t splitmix64(uint64_t& x) 
+        {
+            uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+    public:
+        explicit Xoshiro256(uint64_t seed = 0) 
+        {
+            this->seed(seed);
+        }
+
+        void seed(uint64_t value) 
+        {
+            for (int i = 0; i < 4; ++i) 
+            {
+                s[i] = splitmix64(value);
+            }
+        }
+
+        uint64_t next() 
+        {
+            const uint64_t result = rotl(s[1] * 5, 7) * 9;
+            const uint64_t t = s[1] << 17;
+
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+
+            return result;
+        }
+
+        // 均勻分布於 [0, n) 的整數 (Lemire 乘法縮放，遇到會造成偏差的少數值才重抽)
+        uint32_t nextBelow(uint32_t n) 
+        {
+            uint64_t m = (next() >> 32) * n;
+            uint32_t low = static_cast<uint32_t>(m);
+            if (low < n) 
+            {
+                uint32_t threshold = (0u - n) % n;
+                while (low < threshold) 
+                {
+                    m = (next() >> 32) * n;
+                    low = static_cast<uint32_t>(m);
+                }
+            }
+            return static_cast<uint32_t>(m >> 32);
+        }
+};
+
+#endif
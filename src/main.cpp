@@ -1,24 +1,135 @@
 /* 
+Build (see Makefile): make / make test / make pgo
+
 Compile command:
 g++ -std=c++11 ./src/main.cpp\
-    ./src/Game.cpp ./src/Board.cpp ./src/Tetromino.cpp ./src/InputHandler.cpp ./src/Renderer.cpp\
-    ./src/ScoreManager.cpp ./src/AudioManager.cpp\
-    -o oblivionis
+    ./src/Game.cpp ./src/Simulator.cpp ./src/Randomizer.cpp ./src/Board.cpp ./src/Tetromino.cpp ./src/InputHandler.cpp ./src/Renderer.cpp\
+    ./src/RenderThread.cpp ./src/ScoreManager.cpp ./src/AudioManager.cpp ./src/AudioMixer.cpp ./src/MusicStream.cpp ./src/Bot.cpp ./src/BoardBatch.cpp ./src/Replay.cpp ./src/FrameTimer.cpp ./src/Config.cpp ./src/Versus.cpp ./src/Spectator.cpp ./src/Checkpoint.cpp ./src/Leaderboard.cpp\
+    -pthread -o oblivionis
     
 test mode:
 g++ -std=c++11 -DTEST_MODE ./src/main.cpp\
-    ./src/Game.cpp ./src/Board.cpp ./src/Tetromino.cpp ./src/InputHandler.cpp ./src/Renderer.cpp\
-    ./src/ScoreManager.cpp ./src/AudioManager.cpp\
-    -o oblivionis
+    ./src/Game.cpp ./src/Simulator.cpp ./src/Randomizer.cpp ./src/Board.cpp ./src/Tetromino.cpp ./src/InputHandler.cpp ./src/Renderer.cpp\
+    ./src/RenderThread.cpp ./src/ScoreManager.cpp ./src/AudioManager.cpp ./src/AudioMixer.cpp ./src/MusicStream.cpp ./src/Bot.cpp ./src/BoardBatch.cpp ./src/Replay.cpp ./src/FrameTimer.cpp ./src/Config.cpp ./src/Versus.cpp ./src/Spectator.cpp ./src/Checkpoint.cpp ./src/Leaderboard.cpp\
+    -pthread -o oblivionis
+
+options:
+./oblivionis --bot                 由內建機器人自動遊玩
+./oblivionis --seed 42             指定種子，同樣的種子產生同樣的方塊序列
+./oblivionis --randomizer bag      方塊產生規則：random (預設)、bag (7-bag)、history
+./oblivionis --record game.obr     結束時把這一局存成重播檔
+./oblivionis --replay game.obr     以實際速度播放重播檔並比對結束狀態 (無頭批次驗證請用 tools/replay.cpp)
+./oblivionis --timings frame.tsv   在分數框右側顯示各階段耗時 (p50/p99/max)，結束時把完整直方圖寫到 frame.tsv
+./oblivionis --config my.txt       使用其他設定檔 (預設 ./src/config.txt)，遊戲中修改會即時套用
+./oblivionis --host /tmp/vs.sock   建立雙人對戰並等待對手連線 (同一台機器，另一個終端機執行 --join)
+./oblivionis --join /tmp/vs.sock   加入對戰，種子與方塊產生規則由主機決定；消 2/3/4 行送對手 1/2/4 行垃圾
+./oblivionis --resume             從存檔 (./oblivionis.ckpt) 繼續上一局；關卡之間與遊戲中每秒存檔，堆滿或完成後作廢
+./oblivionis --checkpoint my.ckpt  使用其他存檔位置
+./oblivionis --broadcast /obl      把每一幀廣播到 POSIX 共享記憶體 /obl (不影響遊戲速度)
+./oblivionis --spectate /obl       以唯讀方式觀看 /obl 的廣播，可以同時開任意多個
+./oblivionis --leaderboard         印出前 20 名與各結束關卡的分數分布 (p50/p90/p99/最高) 後離開
+./oblivionis --scores my.scores    使用其他成績記錄檔 (預設 ./oblivionis.scores)；每一局堆滿或完成後自動記錄
 */
 
 #include "Game.hpp"
 #include "AudioManager.hpp"
+#include "Leaderboard.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
-int main() 
+namespace 
 {
-    Game game;
-    game.init();
+    // --leaderboard 列出的名次數
+    const int LEADERBOARD_TOP = 20;
+}
+
+int main(int argc, char* argv[]) 
+{
+    GameOptions options = {};
+    bool showLeaderboard = false;
+    for (int i = 1; i < argc; ++i) 
+    {
+        if (std::strcmp(argv[i], "--bot") == 0) 
+        {
+            options.bot = true;
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) 
+        {
+            options.hasSeed = true;
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) 
+        {
+            options.recordPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) 
+        {
+            options.replayPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--timings") == 0 && i + 1 < argc) 
+        {
+            options.timingPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) 
+        {
+            options.configPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--host") == 0 && i + 1 < argc) 
+        {
+            options.hostPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--join") == 0 && i + 1 < argc) 
+        {
+            options.joinPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--resume") == 0) 
+        {
+            options.resume = true;
+        }
+        else if (std::strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) 
+        {
+            options.checkpointPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--broadcast") == 0 && i + 1 < argc) 
+        {
+            options.broadcastName = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--spectate") == 0 && i + 1 < argc) 
+        {
+            // 觀戰模式不需要遊戲的其他部分
+            return runSpectator(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--scores") == 0 && i + 1 < argc) 
+        {
+            options.scoresPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--leaderboard") == 0) 
+        {
+            // 等所有參數讀完 (--scores 可能在後面) 再查詢
+            showLeaderboard = true;
+        }
+        else if (std::strcmp(argv[i], "--randomizer") == 0 && i + 1 < argc) 
+        {
+            if (!parseRandomizerMode(argv[++i], options.randomizer)) 
+            {
+                std::fprintf(stderr, "unknown randomizer %s (random, bag, history)\n", argv[i]);
+                return 1;
+            }
+        }
+    }
+
+    if (showLeaderboard) 
+    {
+        return runLeaderboard(options.scoresPath.empty() ? defaultLeaderboardPath(Board::WIDTH, Board::HEIGHT) : options.scoresPath,
+                              LEADERBOARD_TOP);
+    }
+
+    Game game(options);
+    if (!game.init()) 
+    {
+        return 1;
+    }
     game.run();
     return 0;
 }
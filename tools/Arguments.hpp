@@ -0,0 +1,59 @@
+#ifndef ARGUMENTS
+#define ARGUMENTS
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+
+// 命令列的數字參數：整個字串都必須是十進位數字且落在 [min, max]，
+// 不像 atoi 把 "--help" 或打錯的字當成 0 默默接受
+
+inline bool parseInteger(const char* text, long long min, long long max, long long& out)
+{
+    if (!text || *text == '\0')
+    {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    long long value = std::strtoll(text, &end, 10);
+    if (errno != 0 || *end != '\0' || value < min || value > max)
+    {
+        return false;
+    }
+    out = value;
+    return true;
+}
+
+inline bool parseInteger(const char* text, int min, int max, int& out)
+{
+    long long value = 0;
+    if (!parseInteger(text, static_cast<long long>(min), static_cast<long long>(max), value))
+    {
+        return false;
+    }
+    out = static_cast<int>(value);
+    return true;
+}
+
+// 種子：0 ~ 2^64 - 1 (strtoull 會接受負號，這裡不接受)
+inline bool parseSeed(const char* text, uint64_t& out)
+{
+    if (!text || *text < '0' || *text > '9')
+    {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long value = std::strtoull(text, &end, 10);
+    if (errno != 0 || *end != '\0')
+    {
+        return false;
+    }
+    out = static_cast<uint64_t>(value);
+    return true;
+}
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef WORKSTEALINGPOOL
+#define WORKSTEALINGPOOL
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作竊取執行緒池：每個工作者有自己的佇列，從尾端取自己的工作，
+// 自己的佇列空了就從其他工作者佇列的前端偷，長短不一的對局也能把所有核心塞滿。
+// 工作之間不共用任何鎖，只有佇列本身各自上鎖，核心數增加時吞吐量接近線性成長
+class WorkStealingPool 
+{
+    public:
+        // 參數為執行這個工作的工作者編號 (0 ~ size()-1)，可用來索引每個工作者專屬的資源
+        typedef std::function<void(int)> Task;
+
+    private:
+        struct Worker 
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> threads;
+
+        std::mutex idleMutex;
+        std::condition_variable wakeCv;   // 有新工作或要停止時喚醒閒置的工作者
+        std::condition_variable doneCv;   // 所有工作完成時喚醒 wait()
+        std::atomic<long> queued;         // 還在佇列中的工作數
+        std::atomic<long> pending;        // 已提交但尚未完成的工作數
+        std::atomic<unsigned> nextWorker; // 提交時輪流分配的佇列
+        bool stopping;
+
+        bool popLocal(int index, Task& task) 
+        {
+            Worker& worker = *workers[index];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            if (worker.tasks.empty()) 
+            {
+                return false;
+            }
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            return true;
+        }
+
+        bool steal(int thief, Task& task) 
+        {
+            int count = static_cast<int>(workers.size());
+            for (int i = 1; i < count; ++i) 
+            {
+                Worker& victim = *workers[(thief + i) % count];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.tasks.empty()) 
+                {
+                    task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void workerLoop(int index) 
+        {
+            for (;;) 
+            {
+                Task task;
+                if (popLocal(index, task) || steal(index, task)) 
+                {
+                    queued--;
+                    task(index);
+
+                    if (--pending == 0) 
+                    {
+                        std::lock_guard<std::mutex> lock(idleMutex);
+                        doneCv.notify_all();
+                    }
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(idleMutex);
+                wakeCv.wait(lock, [this] { return stopping || queued > 0; });
+                if (stopping && queued == 0) 
+                {
+                    return;
+                }
+            }
+        }
+
+    public:
+        explicit WorkStealingPool(int threadCount)
+        : queued(0),
+          pending(0),
+          nextWorker(0),
+          stopping(false)
+        {
+            if (threadCount < 1) 
+            {
+                threadCount = 1;
+            }
+            for (int i = 0; i < threadCount; ++i) 
+            {
+                workers.push_back(std::unique_ptr<Worker>(new Worker()));
+            }
+            for (int i = 0; i < threadCount; ++i) 
+            {
+                threads.push_back(std::thread(&WorkStealingPool::workerLoop, this, i));
+            }
+        }
+
+        ~WorkStealingPool() 
+        {
+            {
+                std::lock_guard<std::mutex> lock(idleMutex);
+                stopping = true;
+            }
+            wakeCv.notify_all();
+            for (std::thread& thread : threads) 
+            {
+                thread.join();
+            }
+        }
+
+        int size() const 
+        {
+            return static_cast<int>(workers.size());
+        }
+
+        // 提交一個工作 (可從任何執行緒呼叫)
+        void submit(Task task) 
+        {
+            pending++;
+            Worker& worker = *workers[nextWorker++ % workers.size()];
+            {
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                worker.tasks.push_back(std::move(task));
+            }
+
+            // 在 idleMutex 內遞增並通知，閒置的工作者不會錯過喚醒
+            std::lock_guard<std::mutex> lock(idleMutex);
+            queued++;
+            wakeCv.notify_one();
+        }
+
+        // 等待目前提交的工作全部完成
+        void wait() 
+        {
+            std::unique_lock<std::mutex> lock(idleMutex);
+            doneCv.wait(lock, [this] { return pending == 0; });
+        }
+};
+
+#endif
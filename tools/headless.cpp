@@ -0,0 +1,193 @@
+/* 
+無頭批次模擬：由 Bot 自動遊玩多局，不碰終端機與音效，用來做長時間測試與量測效能
+
+Compile command:
+g++ -std=c++11 -O2 ./tools/headless.cpp\
+    ./src/Simulator.cpp ./src/Randomizer.cpp ./src/Board.cpp ./src/Tetromino.cpp ./src/ScoreManager.cpp ./src/Bot.cpp ./src/BoardBatch.cpp ./src/Leaderboard.cpp\
+    -o headless
+
+Usage:
+./headless [--scores FILE|-] [games] [maxPieces] [seed] [random|bag|history] [WxH] [scalar|ssse3|avx2]
+
+WxH 為棋盤尺寸 (預設 10x20)，只能使用 Board.hpp 中 BOARD_VARIANTS 列出的尺寸；
+最後一個參數指定 Bot 批次評估的核心 (預設為 CPU 支援的最快核心)，各核心的對局結果完全相同。
+堆滿或完成的每一局都寫進成績記錄 (預設為該尺寸的 defaultLeaderboardPath()，--scores - 不記錄)，
+達到 maxPieces 而中止的局不記錄。
+games 與 maxPieces 至少為 1；參數不是數字、超出範圍或多出參數時印出用法，結束碼為 2
+*/
+
+#include "../src/Simulator.hpp"
+#include "../src/Bot.hpp"
+#include "../src/Leaderboard.hpp"
+#include "Arguments.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace 
+{
+    // 以棋盤型別實體化的整個批次：模擬與 Bot 都使用該尺寸特化的版本
+    template <class BoardT>
+    int runGames(int games, long long maxPieces, uint64_t seed, RandomizerMode mode, BatchKernel kernel, std::string scoresPath) 
+    {
+        Leaderboard leaderboard;
+        if (scoresPath != "-") 
+        {
+            std::string error;
+            if (scoresPath.empty()) 
+            {
+                scoresPath = defaultLeaderboardPath(BoardT::WIDTH, BoardT::HEIGHT);
+            }
+            if (!leaderboard.open(scoresPath, BoardT::WIDTH, BoardT::HEIGHT, error)) 
+            {
+                std::fprintf(stderr, "%s\n", error.c_str());
+                return 1;
+            }
+        }
+
+        // Bot 內含固定大小的 BFS 工作空間，不放在堆疊上
+        static BasicBot<BoardT> bot;
+        bot.setBatchKernel(kernel);
+
+        long long totalPieces = 0;
+        long long totalLines = 0;
+        unsigned long long totalTicks = 0;
+        double placementSeconds = 0.0;
+
+        auto begin = std::chrono::steady_clock::now();
+
+        for (int game = 0; game < games; ++game) 
+        {
+            // 第 game 局使用種子 seed + game，同樣的參數每次都得到同樣的結果
+            BasicSimulator<BoardT> simulator(seed + game, mode);
+            bot.reset();
+            long long pieces = 0;
+            long long lines = 0;
+
+            while (!simulator.isOver() && pieces < maxPieces) 
+            {
+                auto t0 = std::chrono::steady_clock::now();
+                InputState input = bot.nextInput(simulator.getBoard(), simulator.getTetromino());
+                placementSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+                StepEvents events = simulator.step(input);
+                if (events.locked) 
+                {
+                    bot.reset();
+                    pieces++;
+                    lines += events.lines.count;
+                }
+            }
+
+            std::printf("game %d: score %d, level %d, pieces %lld, lines %lld, ticks %llu%s\n",
+                        game, simulator.getScoreManager().getScore(), simulator.getLevel(), pieces, lines,
+                        simulator.getTick(), simulator.isOver() ? "" : " (piece limit)");
+
+            if (leaderboard.isOpen() && simulator.isOver()) 
+            {
+                std::string error;
+                LeaderboardRecord record = makeLeaderboardRecord(simulator.getScoreManager().getScore(), static_cast<int>(lines),
+                                                                 simulator.getLevel(), simulator.getTick(), seed + game,
+                                                                 mode, RunSource::Headless);
+                if (!leaderboard.append(record, error)) 
+                {
+                    std::fprintf(stderr, "%s\n", error.c_str());
+                    return 1;
+                }
+            }
+
+            totalPieces += pieces;
+            totalLines += lines;
+            totalTicks += simulator.getTick();
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        std::printf("total: %d games, %lld pieces, %lld lines, %llu ticks in %.3f s\n",
+                    games, totalPieces, totalLines, totalTicks, seconds);
+        if (totalTicks > 0) 
+        {
+            std::printf("bot (%s): %.3f us per tick, %.1f us per piece\n", batchKernelName(kernel),
+                        placementSeconds * 1e6 / totalTicks,
+                        totalPieces > 0 ? placementSeconds * 1e6 / totalPieces : 0.0);
+        }
+        if (leaderboard.isOpen()) 
+        {
+            std::printf("leaderboard: %s, %llu runs\n", scoresPath.c_str(), static_cast<unsigned long long>(leaderboard.size()));
+        }
+        return 0;
+    }
+
+    int usage(const char* program) 
+    {
+        std::fprintf(stderr, "usage: %s [--scores FILE|-] [games] [maxPieces] [seed] [random|bag|history] [WxH] [scalar|ssse3|avx2]\n",
+                     program);
+        return 2;
+    }
+}
+
+int main(int argc, char* argv[]) 
+{
+    const char* program = argv[0];
+
+    // 唯一的選項放在位置參數之前
+    std::string scoresPath;
+    if (argc > 2 && std::strcmp(argv[1], "--scores") == 0) 
+    {
+        scoresPath = argv[2];
+        argv += 2;
+        argc -= 2;
+    }
+
+    int games = 10;
+    long long maxPieces = 100000;
+    uint64_t seed = Simulator::DEFAULT_SEED;
+    if (argc > 7 || (argc > 1 && !parseInteger(argv[1], 1, 1 << 30, games))
+        || (argc > 2 && !parseInteger(argv[2], 1LL, 1LL << 62, maxPieces))
+        || (argc > 3 && !parseSeed(argv[3], seed))) 
+    {
+        return usage(program);
+    }
+
+    RandomizerMode mode = RandomizerMode::Random;
+    if (argc > 4 && !parseRandomizerMode(argv[4], mode)) 
+    {
+        std::fprintf(stderr, "unknown randomizer %s (random, bag, history)\n", argv[4]);
+        return usage(program);
+    }
+
+    const char* size = argc > 5 ? argv[5] : "10x20";
+
+    BatchKernel kernel = detectBatchKernel();
+    BatchKernel requested = kernel;
+    if (argc > 6 && !parseBatchKernel(argv[6], requested)) 
+    {
+        std::fprintf(stderr, "unknown kernel %s (scalar, ssse3, avx2)\n", argv[6]);
+        return usage(program);
+    }
+    if (requested > kernel) 
+    {
+        std::fprintf(stderr, "%s is not supported on this CPU, using %s\n", argv[6], batchKernelName(kernel));
+    }
+    else 
+    {
+        kernel = requested;
+    }
+
+    // 每一種尺寸各自是一份編譯好的程式碼，這裡只在開始時挑選一次
+    #define HEADLESS_DISPATCH(w, h) \
+        if (std::strcmp(size, #w "x" #h) == 0) \
+        { \
+            return runGames<BasicBoard<w, h> >(games, maxPieces, seed, mode, kernel, scoresPath); \
+        }
+    BOARD_VARIANTS(HEADLESS_DISPATCH)
+    #undef HEADLESS_DISPATCH
+
+    std::fprintf(stderr, "unsupported board size %s (", size);
+    #define HEADLESS_LIST(w, h) std::fprintf(stderr, " " #w "x" #h);
+    BOARD_VARIANTS(HEADLESS_LIST)
+    #undef HEADLESS_LIST
+    std::fprintf(stderr, " )\n");
+    return usage(program);
+}
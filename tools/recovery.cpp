@@ -0,0 +1,390 @@
+/*
+當掉復原檢查：模擬寫到一半當掉的成績記錄與存檔，確認重新開檔後的結果正確
+
+Compile command:
+g++ -std=c++11 -O2 ./tools/recovery.cpp\
+    ./src/Leaderboard.cpp ./src/Checkpoint.cpp ./src/Replay.cpp\
+    ./src/Simulator.cpp ./src/Randomizer.cpp ./src/Board.cpp ./src/Tetromino.cpp ./src/ScoreManager.cpp ./src/Bot.cpp ./src/BoardBatch.cpp\
+    -o recovery
+
+Usage:
+./recovery [records] [seed]
+
+成績記錄：附加 records 筆隨機成績後，把檔頭標成 dirty、以亂數蓋掉索引，並在 count 之後多寫一筆
+(附加到一半、count 尚未增加)，以及把這一筆算進 count (count 已增加、dirty 尚未清除) 兩種情況；
+重新開檔後名次、前 K 名與各關卡的百分位數都必須與逐筆掃描的結果相同。
+存檔：連續存三個世代後破壞最新的槽位，load() 必須取回第二個世代，且之後的模擬與當時完全相同。
+檔案寫在暫存目錄，結束時刪除；有任何不符時結束碼為 1
+*/
+
+#include "../src/Leaderboard.hpp"
+#include "../src/Checkpoint.hpp"
+#include "../src/Replay.hpp"
+#include "../src/Bot.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    const double PERCENTILES[] = { 0.0, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999, 1.0 };
+
+    // 直接對映整個檔案，模擬當掉時留在磁碟上的內容
+    class RawFile
+    {
+        private:
+            void* mapping;
+            size_t size;
+
+        public:
+            explicit RawFile(const std::string& path)
+            : mapping(MAP_FAILED),
+              size(0)
+            {
+                int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+                struct stat info;
+                if (fd != -1 && fstat(fd, &info) == 0)
+                {
+                    size = static_cast<size_t>(info.st_size);
+                    mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                }
+                if (fd != -1)
+                {
+                    ::close(fd);
+                }
+            }
+
+            ~RawFile()
+            {
+                if (mapping != MAP_FAILED)
+                {
+                    munmap(mapping, size);
+                }
+            }
+
+            RawFile(const RawFile&) = delete;
+            RawFile& operator=(const RawFile&) = delete;
+
+            uint8_t* data() const
+            {
+                return mapping == MAP_FAILED ? nullptr : static_cast<uint8_t*>(mapping);
+            }
+    };
+
+    int report(const char* what, int mismatches)
+    {
+        std::printf("%-44s %s", what, mismatches == 0 ? "ok\n" : "FAILED");
+        if (mismatches != 0)
+        {
+            std::printf(" (%d mismatches)\n", mismatches);
+        }
+        return mismatches;
+    }
+
+    // ---- 成績記錄 ----
+
+    LeaderboardRecord randomRecord(std::mt19937_64& rng, uint64_t id)
+    {
+        int lines = static_cast<int>(rng() % 450);
+        int score = lines * LEADERBOARD_BUCKET_WIDTH;
+        if (rng() % 97 == 0)
+        {
+            score += 37;    // 不在桶的整數倍上
+        }
+        if (rng() % 499 == 0)
+        {
+            score += LEADERBOARD_BUCKETS * LEADERBOARD_BUCKET_WIDTH;   // 超出最高的桶
+        }
+        int level = 1 + static_cast<int>(rng() % LEADERBOARD_LEVELS);
+        return makeLeaderboardRecord(score, lines, level, rng() % 100000, id, RandomizerMode::Bag7, RunSource::Headless);
+    }
+
+    // 以逐筆掃描的結果核對名次、前 K 名與百分位數
+    int compareLeaderboard(Leaderboard& leaderboard, const std::vector<LeaderboardRecord>& expected, std::mt19937_64& rng)
+    {
+        int mismatches = 0;
+        if (leaderboard.size() != expected.size())
+        {
+            std::printf("  size %llu, expected %zu\n", static_cast<unsigned long long>(leaderboard.size()), expected.size());
+            mismatches++;
+        }
+
+        std::vector<int> scores;
+        for (const LeaderboardRecord& record : expected)
+        {
+            scores.push_back(record.score);
+        }
+        std::sort(scores.begin(), scores.end());
+
+        int maxScore = scores.empty() ? 0 : scores.back();
+        for (int i = 0; i < 2000; ++i)
+        {
+            int score = static_cast<int>(rng() % (maxScore + 200)) - 100;
+            uint64_t rank = scores.end() - std::upper_bound(scores.begin(), scores.end(), score) + 1;
+            if (leaderboard.rank(score) != rank)
+            {
+                mismatches++;
+            }
+        }
+
+        // 依分數由高到低、同分時較新 (編號較大) 的在前
+        std::vector<LeaderboardRecord> sorted(expected.rbegin(), expected.rend());
+        std::stable_sort(sorted.begin(), sorted.end(), [](const LeaderboardRecord& a, const LeaderboardRecord& b)
+        {
+            return a.score > b.score;
+        });
+        std::vector<LeaderboardRecord> top;
+        leaderboard.top(100, top);
+        if (top.size() != std::min<size_t>(100, sorted.size()))
+        {
+            mismatches++;
+        }
+        for (size_t i = 0; i < top.size() && i < sorted.size(); ++i)
+        {
+            if (top[i].score != sorted[i].score || top[i].seed != sorted[i].seed)
+            {
+                mismatches++;
+            }
+        }
+
+        for (int level = 0; level <= LEADERBOARD_LEVELS; ++level)
+        {
+            std::vector<int> levelScores;
+            for (const LeaderboardRecord& record : expected)
+            {
+                if (level == 0 || record.level == level)
+                {
+                    levelScores.push_back(record.score);
+                }
+            }
+            std::sort(levelScores.begin(), levelScores.end());
+
+            for (double p : PERCENTILES)
+            {
+                int score = 0;
+                bool found = leaderboard.percentile(level, p, score);
+                if (levelScores.empty())
+                {
+                    mismatches += found ? 1 : 0;
+                    continue;
+                }
+                // nearest-rank
+                size_t position = static_cast<size_t>(std::ceil(p * static_cast<double>(levelScores.size())));
+                position = std::min(std::max<size_t>(position, 1), levelScores.size());
+                if (!found || score != levelScores[position - 1])
+                {
+                    mismatches++;
+                }
+            }
+        }
+        return mismatches;
+    }
+
+    // 附加 records 筆後模擬當掉：countBumped 為 false 時最後一筆只寫進記錄區，為 true 時也算進 count
+    int leaderboardCrash(const std::string& path, uint64_t records, uint64_t seed, bool countBumped)
+    {
+        std::remove(path.c_str());
+        std::mt19937_64 rng(seed);
+        std::vector<LeaderboardRecord> expected;
+        std::string error;
+        {
+            Leaderboard leaderboard;
+            if (!leaderboard.open(path, 10, 20, error))
+            {
+                std::printf("  %s\n", error.c_str());
+                return 1;
+            }
+            for (uint64_t id = 0; id < records; ++id)
+            {
+                LeaderboardRecord record = randomRecord(rng, id);
+                if (!leaderboard.append(record, error))
+                {
+                    std::printf("  %s\n", error.c_str());
+                    return 1;
+                }
+                expected.push_back(record);
+            }
+        }
+
+        {
+            RawFile file(path);
+            if (!file.data())
+            {
+                return 1;
+            }
+            LeaderboardHeader* header = reinterpret_cast<LeaderboardHeader*>(file.data());
+            LeaderboardIndex* index = reinterpret_cast<LeaderboardIndex*>(file.data() + sizeof(LeaderboardHeader));
+            LeaderboardRecord* slots = reinterpret_cast<LeaderboardRecord*>(file.data() + sizeof(LeaderboardHeader) + sizeof(LeaderboardIndex));
+
+            // 寫到一半的附加：記錄已寫入、dirty 已標記、索引只更新了一部分 (這裡整個換成亂數)
+            if (header->count < header->capacity)
+            {
+                LeaderboardRecord record = randomRecord(rng, records);
+                record.next = 0;
+                slots[header->count] = record;
+                if (countBumped)
+                {
+                    header->count++;
+                    expected.push_back(record);
+                }
+            }
+            header->dirty = 1;
+            uint64_t* words = reinterpret_cast<uint64_t*>(index);
+            for (size_t i = 0; i < sizeof(LeaderboardIndex) / sizeof(uint64_t); ++i)
+            {
+                words[i] = rng();
+            }
+        }
+
+        Leaderboard leaderboard;
+        if (!leaderboard.open(path, 10, 20, error))
+        {
+            std::printf("  %s\n", error.c_str());
+            return 1;
+        }
+        int mismatches = compareLeaderboard(leaderboard, expected, rng);
+
+        RawFile file(path);
+        if (!file.data() || reinterpret_cast<LeaderboardHeader*>(file.data())->dirty != 0)
+        {
+            mismatches++;
+        }
+        return mismatches;
+    }
+
+    // ---- 存檔 ----
+
+    // 由 Bot 推進 ticks 個 tick
+    void play(Simulator& simulator, Bot& bot, int ticks)
+    {
+        for (int i = 0; i < ticks && !simulator.isOver(); ++i)
+        {
+            if (simulator.step(bot.nextInput(simulator.getBoard(), simulator.getTetromino())).locked)
+            {
+                bot.reset();
+            }
+        }
+    }
+
+    bool sameState(const Simulator& a, const Simulator& b)
+    {
+        return a.getTick() == b.getTick() && a.getLevel() == b.getLevel() && a.isOver() == b.isOver()
+               && hashGameState(a.getBoard(), a.getScoreManager()) == hashGameState(b.getBoard(), b.getScoreManager());
+    }
+
+    int checkpointCrash(const std::string& path, uint64_t seed)
+    {
+        std::remove(path.c_str());
+        static Bot bot;
+        Simulator simulator(seed, RandomizerMode::Bag7);
+        SimulatorState previous;
+        std::string error;
+        {
+            Checkpoint checkpoint;
+            if (!checkpoint.open(path, error))
+            {
+                std::printf("  %s\n", error.c_str());
+                return 1;
+            }
+            for (int generation = 1; generation <= 3; ++generation)
+            {
+                play(simulator, bot, 400);
+                if (generation == 2)
+                {
+                    simulator.saveState(previous);
+                }
+                checkpoint.save(simulator, generation == 3);
+            }
+        }
+
+        // 最新的槽位寫到一半：世代編號已更新，狀態只寫了一部分
+        {
+            RawFile file(path);
+            if (!file.data())
+            {
+                return 1;
+            }
+            CheckpointFile* raw = reinterpret_cast<CheckpointFile*>(file.data());
+            int newest = raw->slots[0].generation > raw->slots[1].generation ? 0 : 1;
+            if (raw->slots[newest].generation != 3)
+            {
+                std::printf("  newest generation %llu, expected 3\n", static_cast<unsigned long long>(raw->slots[newest].generation));
+                return 1;
+            }
+            uint8_t* state = reinterpret_cast<uint8_t*>(&raw->slots[newest].state);
+            state[sizeof(SimulatorState) / 2] ^= 0x5A;
+        }
+
+        Checkpoint checkpoint;
+        SimulatorState loaded;
+        if (!checkpoint.open(path, error) || !checkpoint.load(loaded))
+        {
+            std::printf("  no checkpoint after corrupting the newest slot\n");
+            return 1;
+        }
+
+        // 取回的必須是第二個世代，且繼續模擬的結果與當時相同
+        int mismatches = 0;
+        Simulator resumed;
+        Simulator reference;
+        resumed.loadState(loaded);
+        reference.loadState(previous);
+        if (!sameState(resumed, reference))
+        {
+            mismatches++;
+        }
+        bot.reset();
+        play(resumed, bot, 2000);
+        bot.reset();
+        play(reference, bot, 2000);
+        if (!sameState(resumed, reference))
+        {
+            mismatches++;
+        }
+        return mismatches;
+    }
+
+    std::string temporaryDirectory()
+    {
+        const char* base = std::getenv("TMPDIR");
+        std::string pattern = std::string(base && *base ? base : "/tmp") + "/oblivionis-recovery-XXXXXX";
+        std::vector<char> buffer(pattern.begin(), pattern.end());
+        buffer.push_back('\0');
+        return mkdtemp(buffer.data()) ? std::string(buffer.data()) : std::string();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : Simulator::DEFAULT_SEED;
+
+    std::string directory = temporaryDirectory();
+    if (directory.empty())
+    {
+        std::perror("mkdtemp");
+        return 2;
+    }
+    std::string scores = directory + "/recovery.scores";
+    std::string checkpoint = directory + "/recovery.ckpt";
+
+    int failures = 0;
+    failures += report("leaderboard: torn append before count", leaderboardCrash(scores, records, seed, false));
+    failures += report("leaderboard: torn append after count", leaderboardCrash(scores, records, seed + 1, true));
+    failures += report("leaderboard: torn first append", leaderboardCrash(scores, 0, seed + 2, true));
+    failures += report("checkpoint: corrupted newest slot", checkpointCrash(checkpoint, seed));
+
+    std::remove(scores.c_str());
+    std::remove(checkpoint.c_str());
+    rmdir(directory.c_str());
+    return failures > 0 ? 1 : 0;
+}
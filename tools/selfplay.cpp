@@ -0,0 +1,482 @@
+/* 
+多核心自我對局：在工作竊取執行緒池上平行跑大量無頭對局 (每局各自的種子)，
+以演化搜尋調整 Bot 的評估權重，並回報每組關卡門檻 / 重力曲線下的分數、消行與到達關卡的分布
+
+Compile command:
+g++ -std=c++11 -O2 ./tools/selfplay.cpp\
+    ./src/Simulator.cpp ./src/Randomizer.cpp ./src/Board.cpp ./src/Tetromino.cpp ./src/ScoreManager.cpp ./src/Bot.cpp ./src/BoardBatch.cpp\
+    -pthread -o selfplay
+
+Usage:
+./selfplay [--threads N] [--games N] [--seed S] [--max-pieces N] [--randomizer random|bag|history]
+           [--generations N] [--population N]
+           [--curve t1,...,t10[/g1,...,g10]] ...
+
+--curve 可重複指定，每組包含 10 個升級分數門檻，"/" 之後可選擇性接 10 個重力 (毫秒)；
+未指定時使用 Simulator 內建的曲線。演化搜尋使用第一組曲線。
+數字參數不是整數或超出範圍 (threads、games、max-pieces 至少 1，population 至少 2) 時印出用法，結束碼為 2
+*/
+
+#include "../src/Simulator.hpp"
+#include "../src/Bot.hpp"
+#include "WorkStealingPool.hpp"
+#include "Arguments.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace 
+{
+    const int WEIGHT_COUNT = 6;
+
+    // 一組關卡曲線；沒有指定的部分沿用 Simulator 的預設值
+    struct LevelCurve 
+    {
+        std::string label;
+        bool hasThresholds;
+        bool hasGravity;
+        int thresholds[Simulator::MAX_LEVEL];
+        int gravityMs[Simulator::MAX_LEVEL];
+    };
+
+    struct GameResult 
+    {
+        int score;
+        int lines;
+        int level;       // 結束時所在關卡 (MAX_LEVEL + 1 表示完成所有關卡)
+        long long pieces;
+    };
+
+    struct Options 
+    {
+        int threads;
+        int games;
+        uint64_t seed;
+        long long maxPieces;
+        RandomizerMode randomizer;
+        int generations;
+        int population;
+        std::vector<LevelCurve> curves;
+    };
+
+    void toArray(const BotWeights& w, double (&out)[WEIGHT_COUNT]) 
+    {
+        out[0] = w.aggregateHeight;
+        out[1] = w.lines;
+        out[2] = w.holes;
+        out[3] = w.bumpiness;
+        out[4] = w.wells;
+        out[5] = w.rowTransitions;
+    }
+
+    BotWeights fromArray(const double (&in)[WEIGHT_COUNT]) 
+    {
+        BotWeights w;
+        w.aggregateHeight = in[0];
+        w.lines = in[1];
+        w.holes = in[2];
+        w.bumpiness = in[3];
+        w.wells = in[4];
+        w.rowTransitions = in[5];
+        return w;
+    }
+
+    // 評估結果只取決於權重的方向，統一縮放到單位長度方便比較
+    BotWeights normalize(const BotWeights& w) 
+    {
+        double a[WEIGHT_COUNT];
+        toArray(w, a);
+        double norm = 0.0;
+        for (double x : a) 
+        {
+            norm += x * x;
+        }
+        norm = std::sqrt(norm);
+        if (norm > 0.0) 
+        {
+            for (double& x : a) 
+            {
+                x /= norm;
+            }
+        }
+        return fromArray(a);
+    }
+
+    bool parseList(const char* text, int (&out)[Simulator::MAX_LEVEL]) 
+    {
+        for (int i = 0; i < Simulator::MAX_LEVEL; ++i) 
+        {
+            char* end = nullptr;
+            long value = std::strtol(text, &end, 10);
+            if (end == text || value <= 0) 
+            {
+                return false;
+            }
+            out[i] = static_cast<int>(value);
+            text = end;
+            if (i + 1 < Simulator::MAX_LEVEL) 
+            {
+                if (*text != ',') 
+                {
+                    return false;
+                }
+                text++;
+            }
+        }
+        return *text == '\0' || *text == '/';
+    }
+
+    bool parseCurve(const char* text, LevelCurve& curve) 
+    {
+        curve.label = text;
+        curve.hasThresholds = true;
+        curve.hasGravity = false;
+        if (!parseList(text, curve.thresholds)) 
+        {
+            return false;
+        }
+
+        const char* slash = std::strchr(text, '/');
+        if (slash) 
+        {
+            curve.hasGravity = true;
+            return parseList(slash + 1, curve.gravityMs);
+        }
+        return true;
+    }
+
+    GameResult playGame(Bot& bot, const LevelCurve& curve, uint64_t seed, RandomizerMode mode, long long maxPieces) 
+    {
+        Simulator simulator(seed, mode);
+        if (curve.hasThresholds) 
+        {
+            simulator.setLevelThresholds(curve.thresholds);
+        }
+        if (curve.hasGravity) 
+        {
+            simulator.setGravityMs(curve.gravityMs);
+        }
+
+        bot.reset();
+        GameResult result = {};
+
+        while (!simulator.isOver() && result.pieces < maxPieces) 
+        {
+            StepEvents events = simulator.step(bot.nextInput(simulator.getBoard(), simulator.getTetromino()));
+            if (events.locked) 
+            {
+                bot.reset();
+                result.pieces++;
+                result.lines += events.lines.count;
+            }
+        }
+
+        result.score = simulator.getScoreManager().getScore();
+        result.level = simulator.getLevel();
+        return result;
+    }
+
+    // 每個工作者一個 Bot：BFS 工作空間不共用，工作之間沒有任何同步
+    class Runner 
+    {
+        private:
+            WorkStealingPool pool;
+            std::vector<std::unique_ptr<Bot>> bots;
+
+        public:
+            explicit Runner(int threads)
+            : pool(threads)
+            {
+                for (int i = 0; i < pool.size(); ++i) 
+                {
+                    bots.push_back(std::unique_ptr<Bot>(new Bot()));
+                }
+            }
+
+            int size() const 
+            {
+                return pool.size();
+            }
+
+            // 以每組權重各跑 games 局 (所有權重使用同一批種子)，結果依 [權重][局] 排列
+            std::vector<GameResult> run(const std::vector<BotWeights>& weights, const LevelCurve& curve,
+                                        int games, uint64_t seed, RandomizerMode mode, long long maxPieces) 
+            {
+                std::vector<GameResult> results(weights.size() * games);
+
+                for (size_t w = 0; w < weights.size(); ++w) 
+                {
+                    for (int g = 0; g < games; ++g) 
+                    {
+                        GameResult* slot = &results[w * games + g];
+                        const BotWeights* weight = &weights[w];
+                        const LevelCurve* levelCurve = &curve;
+                        std::vector<std::unique_ptr<Bot>>* workerBots = &bots;
+
+                        pool.submit([=](int worker) 
+                        {
+                            Bot& bot = *(*workerBots)[worker];
+                            bot.setWeights(*weight);
+                            *slot = playGame(bot, *levelCurve, seed + g, mode, maxPieces);
+                        });
+                    }
+                }
+
+                pool.wait();
+                return results;
+            }
+    };
+
+    double meanLines(const GameResult* results, int games) 
+    {
+        double sum = 0.0;
+        for (int i = 0; i < games; ++i) 
+        {
+            sum += results[i].lines;
+        }
+        return sum / games;
+    }
+
+    int percentile(std::vector<int> values, double p) 
+    {
+        std::sort(values.begin(), values.end());
+        size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+        return values[index];
+    }
+
+    void printWeights(const char* prefix, const BotWeights& w) 
+    {
+        std::printf("%sheight %.4f, lines %.4f, holes %.4f, bumpiness %.4f, wells %.4f, transitions %.4f\n",
+                    prefix, w.aggregateHeight, w.lines, w.holes, w.bumpiness, w.wells, w.rowTransitions);
+    }
+
+    void report(const LevelCurve& curve, const std::vector<GameResult>& results, double seconds) 
+    {
+        std::vector<int> scores;
+        std::vector<int> lines;
+        int levels[Simulator::MAX_LEVEL + 2] = {};
+        long long pieces = 0;
+
+        for (const GameResult& r : results) 
+        {
+            scores.push_back(r.score);
+            lines.push_back(r.lines);
+            levels[std::min(r.level, Simulator::MAX_LEVEL + 1)]++;
+            pieces += r.pieces;
+        }
+
+        std::printf("\n[curve] %s\n", curve.label.c_str());
+        std::printf("  games %zu in %.2f s (%.1f games/s, %.0f pieces/s)\n",
+                    results.size(), seconds, results.size() / seconds, pieces / seconds);
+        std::printf("  score  p10 %d  p50 %d  p90 %d  max %d\n",
+                    percentile(scores, 0.1), percentile(scores, 0.5), percentile(scores, 0.9), percentile(scores, 1.0));
+        std::printf("  lines  p10 %d  p50 %d  p90 %d  max %d\n",
+                    percentile(lines, 0.1), percentile(lines, 0.5), percentile(lines, 0.9), percentile(lines, 1.0));
+        std::printf("  level reached:");
+        for (int level = 1; level <= Simulator::MAX_LEVEL; ++level) 
+        {
+            if (levels[level] > 0) 
+            {
+                std::printf("  L%d %.1f%%", level, 100.0 * levels[level] / results.size());
+            }
+        }
+        std::printf("  completed %.1f%%", 100.0 * levels[Simulator::MAX_LEVEL + 1] / results.size());
+        std::printf("\n");
+    }
+
+    // (mu + lambda) 演化：保留最好的幾組權重，其餘由菁英交配再加上高斯突變產生
+    BotWeights evolve(Runner& runner, const Options& options) 
+    {
+        std::mt19937 rng(static_cast<unsigned>(options.seed));
+        std::normal_distribution<double> noise(0.0, 0.1);
+        int elites = std::max(1, options.population / 4);
+
+        std::vector<BotWeights> population;
+        population.push_back(normalize(defaultBotWeights()));
+        while (static_cast<int>(population.size()) < options.population) 
+        {
+            double a[WEIGHT_COUNT];
+            toArray(population[0], a);
+            for (double& x : a) 
+            {
+                x += noise(rng) * 3.0;
+            }
+            population.push_back(normalize(fromArray(a)));
+        }
+
+        BotWeights best = population[0];
+        for (int generation = 0; generation < options.generations; ++generation) 
+        {
+            // 每一代換一批種子，避免權重只適應特定的方塊序列
+            uint64_t seed = options.seed + 1000003u * (generation + 1);
+            auto begin = std::chrono::steady_clock::now();
+            std::vector<GameResult> results = runner.run(population, options.curves[0], options.games, seed,
+                                                         options.randomizer, options.maxPieces);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+            std::vector<std::pair<double, int>> ranking;
+            for (size_t i = 0; i < population.size(); ++i) 
+            {
+                ranking.push_back(std::make_pair(meanLines(&results[i * options.games], options.games), static_cast<int>(i)));
+            }
+            std::sort(ranking.begin(), ranking.end(), [](const std::pair<double, int>& a, const std::pair<double, int>& b) 
+            {
+                return a.first > b.first;
+            });
+
+            best = population[ranking[0].second];
+            std::printf("[gen %d] best mean lines %.1f, median %.1f (%.2f s)\n", generation, ranking[0].first,
+                        ranking[ranking.size() / 2].first, seconds);
+            printWeights("  ", best);
+
+            std::vector<BotWeights> next;
+            for (int i = 0; i < elites; ++i) 
+            {
+                next.push_back(population[ranking[i].second]);
+            }
+            std::uniform_int_distribution<int> pick(0, elites - 1);
+            while (static_cast<int>(next.size()) < options.population) 
+            {
+                double a[WEIGHT_COUNT];
+                double b[WEIGHT_COUNT];
+                toArray(next[pick(rng)], a);
+                toArray(next[pick(rng)], b);
+                for (int k = 0; k < WEIGHT_COUNT; ++k) 
+                {
+                    a[k] = (rng() & 1u ? a[k] : b[k]) + noise(rng);
+                }
+                next.push_back(normalize(fromArray(a)));
+            }
+            population.swap(next);
+        }
+
+        return best;
+    }
+
+    int usage(const char* program) 
+    {
+        std::fprintf(stderr, "usage: %s [--threads N] [--games N] [--seed S] [--max-pieces N] [--randomizer random|bag|history]\n"
+                             "       [--generations N] [--population N] [--curve t1,...,t10[/g1,...,g10]] ...\n", program);
+        return 2;
+    }
+}
+
+int main(int argc, char* argv[]) 
+{
+    Options options;
+    options.threads = static_cast<int>(std::thread::hardware_concurrency());
+    options.games = 100;
+    options.seed = 1;
+    options.randomizer = RandomizerMode::Random;
+    options.maxPieces = 2000;
+    options.generations = 0;
+    options.population = 16;
+
+    for (int i = 1; i < argc; ++i) 
+    {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (arg != "--threads" && arg != "--games" && arg != "--seed" && arg != "--randomizer" && arg != "--max-pieces"
+            && arg != "--generations" && arg != "--population" && arg != "--curve") 
+        {
+            std::fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return usage(argv[0]);
+        }
+        if (!value) 
+        {
+            std::fprintf(stderr, "missing value for %s\n", arg.c_str());
+            return usage(argv[0]);
+        }
+
+        bool valid = true;
+        if (arg == "--threads") 
+        {
+            valid = parseInteger(value, 1, 4096, options.threads);
+        }
+        else if (arg == "--games") 
+        {
+            valid = parseInteger(value, 1, 1 << 30, options.games);
+        }
+        else if (arg == "--seed") 
+        {
+            valid = parseSeed(value, options.seed);
+        }
+        else if (arg == "--randomizer") 
+        {
+            if (!parseRandomizerMode(value, options.randomizer)) 
+            {
+                std::fprintf(stderr, "unknown randomizer %s (random, bag, history)\n", value);
+                return usage(argv[0]);
+            }
+        }
+        else if (arg == "--max-pieces") 
+        {
+            valid = parseInteger(value, 1LL, 1LL << 62, options.maxPieces);
+        }
+        else if (arg == "--generations") 
+        {
+            valid = parseInteger(value, 0, 1 << 20, options.generations);
+        }
+        else if (arg == "--population") 
+        {
+            valid = parseInteger(value, 2, 1 << 20, options.population);
+        }
+        else 
+        {
+            LevelCurve curve;
+            if (!parseCurve(value, curve)) 
+            {
+                std::fprintf(stderr, "invalid curve: %s (expected 10 thresholds, optionally /10 gravity values)\n", value);
+                return usage(argv[0]);
+            }
+            options.curves.push_back(curve);
+        }
+
+        if (!valid) 
+        {
+            std::fprintf(stderr, "invalid value for %s: %s\n", arg.c_str(), value);
+            return usage(argv[0]);
+        }
+        i++;
+    }
+
+    if (options.curves.empty()) 
+    {
+        LevelCurve builtin;
+        builtin.label = "built-in";
+        builtin.hasThresholds = false;
+        builtin.hasGravity = false;
+        options.curves.push_back(builtin);
+    }
+
+    Runner runner(options.threads);
+    std::printf("[selfplay] %d threads, %d games per run, seed %llu, %s randomizer, max %lld pieces per game\n",
+                runner.size(), options.games, static_cast<unsigned long long>(options.seed),
+                randomizerModeName(options.randomizer), options.maxPieces);
+
+    BotWeights weights = defaultBotWeights();
+    if (options.generations > 0) 
+    {
+        weights = evolve(runner, options);
+        printWeights("\n[best weights] ", weights);
+    }
+
+    std::vector<BotWeights> single(1, weights);
+    for (const LevelCurve& curve : options.curves) 
+    {
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<GameResult> results = runner.run(single, curve, options.games, options.seed, options.randomizer, options.maxPieces);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        report(curve, results, seconds);
+    }
+
+    return 0;
+}
@@ -0,0 +1,225 @@
+/*
+對戰測試：fork 出兩個行程，各由一個 Bot 操作，透過 Unix domain socket 以 lockstep 不限速地對戰，
+用來驗證兩邊的模擬結果一致 (每 256 tick 比對一次雜湊，結束時再比對一次) 並量測每個 tick 的往返延遲
+
+Compile command:
+g++ -std=c++11 -O2 ./tools/versus.cpp\
+    ./src/Versus.cpp ./src/Replay.cpp ./src/FrameTimer.cpp\
+    ./src/Simulator.cpp ./src/Randomizer.cpp ./src/Board.cpp ./src/Tetromino.cpp ./src/ScoreManager.cpp ./src/Bot.cpp ./src/BoardBatch.cpp\
+    -o versus
+
+Usage:
+./versus [games] [seed] [random|bag|history] [socketPath]
+*/
+
+#include "../src/Versus.hpp"
+#include "../src/Replay.hpp"
+#include "../src/Bot.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    // 每局的上限，避免兩個 Bot 都不會輸時跑不完
+    const uint64_t MAX_TICKS = 2000000;
+
+    // 兩邊是同一個 Bot，方塊序列也相同的話兩個盤面會一模一樣 (永遠平手)；
+    // 測試時對手改用另一個種子，垃圾行才會有來有往
+    const uint64_t GUEST_SEED_OFFSET = 0x9E3779B97F4A7C15ull;
+
+    struct GameResult
+    {
+        uint64_t ticks;
+        uint64_t stateHash;
+        int hostScore;
+        int guestScore;
+        int winner;         // 0 = 主機, 1 = 對手, -1 = 平手 / 未分勝負
+        int garbage[2];     // 雙方送出的垃圾行數
+    };
+
+    bool lost(const Simulator& simulator)
+    {
+        return simulator.isOver() && simulator.getLevel() <= Simulator::MAX_LEVEL;
+    }
+
+    // 兩個行程各自跑同一局：自己的盤面由 Bot 操作，對手的盤面套用收到的輸入
+    bool playGame(VersusLink& link, uint64_t seed, RandomizerMode mode, Bot& bot, GameResult& result, std::string& error)
+    {
+        Simulator host(seed, mode);
+        Simulator guest(seed + GUEST_SEED_OFFSET, mode);
+        Simulator& self = link.isHost() ? host : guest;
+        bot.reset();
+
+        std::memset(&result, 0, sizeof(result));
+        while (!host.isOver() && !guest.isOver() && host.getTick() < MAX_TICKS)
+        {
+            uint64_t tick = host.getTick();
+            uint64_t hash = tick % VersusLink::HASH_INTERVAL == 0 ? hashVersusState(host, guest) : 0;
+            InputState input = bot.nextInput(self.getBoard(), self.getTetromino());
+
+            uint8_t remote = 0;
+            if (!link.exchange(tick, packInput(input), hash, remote, error))
+            {
+                return false;
+            }
+            InputState remoteInput = unpackInput(remote);
+
+            StepEvents hostEvents;
+            StepEvents guestEvents;
+            if (link.isHost())
+            {
+                stepVersus(host, guest, input, remoteInput, hostEvents, guestEvents);
+            }
+            else
+            {
+                stepVersus(host, guest, remoteInput, input, hostEvents, guestEvents);
+            }
+
+            if ((link.isHost() ? hostEvents : guestEvents).locked)
+            {
+                bot.reset();
+            }
+            result.garbage[0] += hostEvents.garbageSent;
+            result.garbage[1] += guestEvents.garbageSent;
+        }
+
+        result.ticks = host.getTick();
+        result.stateHash = hashVersusState(host, guest);
+        result.hostScore = host.getScoreManager().getScore();
+        result.guestScore = guest.getScoreManager().getScore();
+        result.winner = lost(host) == lost(guest) ? -1 : (lost(host) ? 1 : 0);
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int games = argc > 1 ? std::atoi(argv[1]) : 10;
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : Simulator::DEFAULT_SEED;
+
+    RandomizerMode mode = RandomizerMode::Random;
+    if (argc > 3 && !parseRandomizerMode(argv[3], mode))
+    {
+        std::fprintf(stderr, "unknown randomizer %s (random, bag, history)\n", argv[3]);
+        return 1;
+    }
+    std::string path = argc > 4 ? argv[4] : "/tmp/oblivionis-versus-" + std::to_string(getpid()) + ".sock";
+
+    // 子行程 -> 父行程：每局的結果，用來比對兩邊的結束狀態
+    int results[2];
+    if (pipe(results) == -1)
+    {
+        std::perror("pipe");
+        return 1;
+    }
+
+    pid_t child = fork();
+    if (child == -1)
+    {
+        std::perror("fork");
+        return 1;
+    }
+
+    // Bot 內含固定大小的 BFS 工作空間，不放在堆疊上
+    static Bot bot;
+    VersusLink link;
+    std::string error;
+
+    if (child == 0)
+    {
+        close(results[0]);
+        uint64_t joinedSeed = 0;
+        RandomizerMode joinedMode = RandomizerMode::Random;
+        if (!link.join(path, joinedSeed, joinedMode, error))
+        {
+            std::fprintf(stderr, "[guest] %s\n", error.c_str());
+            _exit(1);
+        }
+        for (int game = 0; game < games; ++game)
+        {
+            GameResult result;
+            if (!playGame(link, joinedSeed + game, joinedMode, bot, result, error))
+            {
+                std::fprintf(stderr, "[guest] game %d: %s\n", game, error.c_str());
+                _exit(1);
+            }
+            if (write(results[1], &result, sizeof(result)) != static_cast<ssize_t>(sizeof(result)))
+            {
+                _exit(1);
+            }
+        }
+        _exit(0);
+    }
+
+    close(results[1]);
+    if (!link.host(path, seed, mode, error))
+    {
+        std::fprintf(stderr, "[host] %s\n", error.c_str());
+        return 1;
+    }
+
+    int failures = 0;
+    int wins[2] = {0, 0};
+    unsigned long long totalTicks = 0;
+    auto begin = std::chrono::steady_clock::now();
+
+    for (int game = 0; game < games; ++game)
+    {
+        GameResult result;
+        GameResult guestResult;
+        if (!playGame(link, seed + game, mode, bot, result, error))
+        {
+            std::fprintf(stderr, "[host] game %d: %s\n", game, error.c_str());
+            failures++;
+            break;
+        }
+        if (read(results[0], &guestResult, sizeof(guestResult)) != static_cast<ssize_t>(sizeof(guestResult)))
+        {
+            std::fprintf(stderr, "[host] game %d: guest exited\n", game);
+            failures++;
+            break;
+        }
+
+        bool same = std::memcmp(&result, &guestResult, sizeof(result)) == 0;
+        if (!same)
+        {
+            failures++;
+        }
+        if (result.winner >= 0)
+        {
+            wins[result.winner]++;
+        }
+        totalTicks += result.ticks;
+
+        if (games <= 20 || !same)
+        {
+            std::printf("game %2d: %s ticks %llu, score %d vs %d, garbage %d vs %d, %s\n", game, same ? "ok" : "MISMATCH",
+                        static_cast<unsigned long long>(result.ticks), result.hostScore, result.guestScore,
+                        result.garbage[0], result.garbage[1],
+                        result.winner < 0 ? "draw" : (result.winner == 0 ? "host wins" : "guest wins"));
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    link.close();
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        failures++;
+    }
+
+    const LatencyHistogram& waits = link.getWaitTimes();
+    std::printf("%d games, %d failed, host %d / guest %d wins, %llu ticks in %.3f s (%.0f ticks/s)\n", games, failures,
+                wins[0], wins[1], totalTicks, seconds, seconds > 0 ? totalTicks / seconds : 0.0);
+    std::printf("round trip (us): p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+                waits.percentile(0.50) / 1000.0, waits.percentile(0.99) / 1000.0,
+                waits.percentile(0.999) / 1000.0, waits.max() / 1000.0);
+    return failures > 0 ? 1 : 0;
+}